@@ -0,0 +1,138 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+static char *block_data(struct tsqlp_arena_block *block) {
+    return (char *) (block + 1);
+}
+
+// Offset of the next allocation in the block, aligned on the actual address
+static size_t block_next_offset(struct tsqlp_arena_block *block) {
+    uintptr_t address = (uintptr_t) (block_data(block) + block->used);
+    uintptr_t aligned = (address + TSQLP_ARENA_ALIGNMENT - 1) & ~(uintptr_t) (TSQLP_ARENA_ALIGNMENT - 1);
+
+    return block->used + (size_t) (aligned - address);
+}
+
+void tsqlp_arena_init(struct tsqlp_arena *arena, struct tsqlp_arena_block *memory, size_t size) {
+    *memory = (struct tsqlp_arena_block) {
+        .previous = NULL,
+        .size = size,
+        .used = 0
+    };
+
+    *arena = (struct tsqlp_arena) {
+        .block = memory,
+        .last = NULL,
+        .overflow = 0
+    };
+}
+
+void *tsqlp_arena_alloc(struct tsqlp_arena *arena, size_t size) {
+    size_t offset = block_next_offset(arena->block);
+
+    if (offset + size > arena->block->size) {
+        size_t block_size = arena->block->size * 2;
+
+        if (block_size < size + TSQLP_ARENA_ALIGNMENT) {
+            block_size = size + TSQLP_ARENA_ALIGNMENT;
+        }
+
+        struct tsqlp_arena_block *block = malloc(sizeof(struct tsqlp_arena_block) + block_size);
+
+        if (block == NULL) {
+            exit(2);
+        }
+
+        *block = (struct tsqlp_arena_block) {
+            .previous = arena->block,
+            .size = block_size,
+            .used = 0
+        };
+
+        arena->block = block;
+        offset = block_next_offset(block);
+    }
+
+    if (arena->block->previous != NULL) {
+        arena->overflow += size + TSQLP_ARENA_ALIGNMENT - 1;
+    }
+
+    arena->block->used = offset + size;
+    arena->last = block_data(arena->block) + offset;
+
+    return arena->last;
+}
+
+void *tsqlp_arena_grow(struct tsqlp_arena *arena, void *ptr, size_t old_size, size_t new_size) {
+    if (ptr != NULL && ptr == arena->last) {
+        size_t offset = (size_t) ((char *) ptr - block_data(arena->block));
+
+        if (offset + new_size <= arena->block->size) {
+            if (arena->block->previous != NULL && offset + new_size > arena->block->used) {
+                arena->overflow += offset + new_size - arena->block->used;
+            }
+
+            arena->block->used = offset + new_size;
+
+            return ptr;
+        }
+    }
+
+    void *grown = tsqlp_arena_alloc(arena, new_size);
+
+    if (ptr != NULL) {
+        memcpy(grown, ptr, old_size < new_size ? old_size : new_size);
+    }
+
+    return grown;
+}
+
+void tsqlp_arena_reset(struct tsqlp_arena *arena) {
+    struct tsqlp_arena_block *newest = arena->block;
+
+    if (newest->previous != NULL) {
+        struct tsqlp_arena_block *block = newest->previous;
+
+        while (block->previous != NULL) {
+            struct tsqlp_arena_block *previous = block->previous;
+
+            free(block);
+            block = previous;
+        }
+
+        block->used = 0;
+        newest->previous = block;
+    }
+
+    newest->used = 0;
+    arena->last = NULL;
+    arena->overflow = 0;
+}
+
+size_t tsqlp_arena_required(const struct tsqlp_arena *arena) {
+    const struct tsqlp_arena_block *first = arena->block;
+
+    while (first->previous != NULL) {
+        first = first->previous;
+    }
+
+    return first->used + arena->overflow;
+}
+
+void tsqlp_arena_destroy(struct tsqlp_arena *arena) {
+    struct tsqlp_arena_block *block = arena->block;
+
+    while (block->previous != NULL) {
+        struct tsqlp_arena_block *previous = block->previous;
+
+        free(block);
+        block = previous;
+    }
+
+    arena->block = block;
+    arena->last = NULL;
+    arena->overflow = 0;
+}
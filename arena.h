@@ -0,0 +1,62 @@
+#ifndef SQL_QUERY_PARSER_ARENA_H
+#define SQL_QUERY_PARSER_ARENA_H
+
+#include <stddef.h>
+
+/*
+ * Bump allocator for everything a parse result owns. Memory is handed out from the current block and a new block,
+ * at least twice as large as the previous one, is allocated when it runs out. Nothing is freed one by one, all the
+ * blocks are freed together by tsqlp_arena_destroy().
+ *
+ * The first block is provided by the owner, so it can live in the same allocation as the owner itself, and it is
+ * never freed by the arena.
+ */
+
+/*
+ * Allocations are aligned on the actual address, so each one may be preceded by up to TSQLP_ARENA_ALIGNMENT - 1 bytes
+ * of padding
+ */
+#define TSQLP_ARENA_ALIGNMENT 16
+
+struct tsqlp_arena_block {
+    struct tsqlp_arena_block *previous;
+    size_t size;
+    size_t used;
+};
+
+struct tsqlp_arena {
+    struct tsqlp_arena_block *block;
+    // Most recent allocation, the only one which can grow in place
+    void *last;
+    // Bytes allocated after the first block ran out, padding included, see tsqlp_arena_required()
+    size_t overflow;
+};
+
+/*
+ * First block header is placed at memory and followed by size bytes for allocations
+ */
+void tsqlp_arena_init(struct tsqlp_arena *arena, struct tsqlp_arena_block *memory, size_t size);
+
+void *tsqlp_arena_alloc(struct tsqlp_arena *arena, size_t size);
+
+/*
+ * Like realloc, but the old memory is not released. Grows in place when ptr is the most recent allocation and its
+ * block has room, ptr may be NULL.
+ */
+void *tsqlp_arena_grow(struct tsqlp_arena *arena, void *ptr, size_t old_size, size_t new_size);
+
+/*
+ * Makes all the memory available again. The newest block, which is the largest one, is kept for the next allocations
+ * and only the blocks between it and the first one are freed, so an arena reused for similar work stops allocating.
+ */
+void tsqlp_arena_reset(struct tsqlp_arena *arena);
+
+/*
+ * Size of a first block which would have held everything allocated since the arena was set up or reset, without any
+ * other block. Exact while nothing was allocated past the first block, an upper bound otherwise.
+ */
+size_t tsqlp_arena_required(const struct tsqlp_arena *arena);
+
+void tsqlp_arena_destroy(struct tsqlp_arena *arena);
+
+#endif //SQL_QUERY_PARSER_ARENA_H
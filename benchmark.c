@@ -0,0 +1,123 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tsqlp.h"
+
+/*
+ * Parses a query with a single literal of growing size and prints the time per megabyte, which stays flat as long as
+ * long literals are scanned in linear time. Then parses "IN (?, ?, ...)" lists of 1k, 10k and 100k placeholders and
+ * prints the time per thousand placeholders, which stays flat as long as placeholders are collected in linear time.
+ *
+ * Usage: tsqlp_benchmark [max size in MB, 100 by default]
+ */
+
+#define MEGABYTE (1024 * 1024)
+
+#define MAX_PLACEHOLDERS 100000
+
+struct literal_kind {
+    const char *name;
+    const char *prefix;
+    const char *suffix;
+    char fill;
+};
+
+static const struct literal_kind literal_kinds[] = {
+    {"string", "SELECT '", "' FROM t", 'a'},
+    {"hex string", "SELECT x'", "' FROM t", 'F'},
+    {"hex number", "SELECT 0x", " FROM t", 'F'},
+    {"backtick", "SELECT `", "` FROM t", 'a'}
+};
+
+static double seconds_now(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+static size_t build_query(char *sql, const struct literal_kind *kind, size_t literal_len) {
+    size_t prefix_len = strlen(kind->prefix);
+    size_t suffix_len = strlen(kind->suffix);
+
+    memcpy(sql, kind->prefix, prefix_len);
+    memset(sql + prefix_len, kind->fill, literal_len);
+    memcpy(sql + prefix_len + literal_len, kind->suffix, suffix_len);
+
+    return prefix_len + literal_len + suffix_len;
+}
+
+static size_t build_placeholder_query(char *sql, size_t placeholders) {
+    size_t len = (size_t) sprintf(sql, "SELECT * FROM t WHERE id IN (?");
+
+    for (size_t i = 1; i < placeholders; i++) {
+        memcpy(sql + len, ", ?", 3);
+        len += 3;
+    }
+
+    sql[len++] = ')';
+
+    return len;
+}
+
+static double parse_timed(const char *sql, size_t len) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+
+    if (parse_result == NULL) {
+        exit(1);
+    }
+
+    double start = seconds_now();
+    tsqlp_parse_status parse_status = tsqlp_parse(sql, len, parse_result);
+    double elapsed = seconds_now() - start;
+
+    tsqlp_parse_result_free(parse_result);
+
+    if (parse_status != TSQLP_PARSE_OK) {
+        fprintf(stderr, "%s\n", tsqlp_parse_status_to_message(parse_status));
+        exit(2);
+    }
+
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 100;
+    // At least a megabyte, which also fits the longest placeholder list
+    char *sql = malloc(max_megabytes * MEGABYTE + 64);
+
+    if (max_megabytes == 0 || sql == NULL) {
+        exit(1);
+    }
+
+    printf("%-12s %10s %12s %12s\n", "literal", "size MB", "parse ms", "ms per MB");
+
+    for (size_t kind = 0; kind < sizeof(literal_kinds) / sizeof(literal_kinds[0]); kind++) {
+        // 1, 10, 100 and so on, always finishing with the maximum size
+        for (size_t megabytes = 1, previous = 0; previous < max_megabytes; previous = megabytes, megabytes *= 10) {
+            megabytes = megabytes < max_megabytes ? megabytes : max_megabytes;
+
+            size_t len = build_query(sql, &literal_kinds[kind], megabytes * MEGABYTE);
+            double elapsed = parse_timed(sql, len);
+
+            printf("%-12s %10zu %12.2f %12.3f\n", literal_kinds[kind].name, megabytes, elapsed * 1e3, elapsed * 1e3 / (double) megabytes);
+        }
+    }
+
+    printf("\n%-12s %10s %12s %12s\n", "placeholders", "count", "parse ms", "ms per 1k");
+
+    for (size_t placeholders = 1000; placeholders <= MAX_PLACEHOLDERS; placeholders *= 10) {
+        double elapsed = parse_timed(sql, build_placeholder_query(sql, placeholders));
+
+        printf("%-12s %10zu %12.2f %12.3f\n", "in list", placeholders, elapsed * 1e3, elapsed * 1e3 / (double) (placeholders / 1000));
+    }
+
+    free(sql);
+
+    return 0;
+}
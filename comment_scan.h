@@ -0,0 +1,69 @@
+#ifndef SQL_QUERY_PARSER_COMMENT_SCAN_H
+#define SQL_QUERY_PARSER_COMMENT_SCAN_H
+
+#include <stddef.h>
+#include <string.h>
+
+#include "lexer.h"
+
+/*
+ * Comment matching shared by both scanners and the structural index. "#" and "-- " comments run to the end of the
+ * line, where "--" has to be followed by a whitespace or control character or by the end of the input, and C style
+ * comments run to their first closing delimiter. Comment bodies are searched with memchr.
+ *
+ * Executable comments, the C style ones starting with "!", are not matched since MySQL runs their content, so
+ * skipping them would hide a part of the statement.
+ */
+
+/*
+ * Returns length of the comment starting at offset, or 0 if there is none. Type is set to T_COMMENT, to
+ * T_OPTIMIZER_HINT for C style comments starting with "+", or to T_UNKNOWN for a C style comment which is never closed
+ * and which then runs to the end.
+ */
+static inline size_t comment_scan_match(const char *buff, size_t offset, size_t len, sql_token_type *type) {
+    char first = buff[offset];
+
+    if (first != '#' && first != '-' && first != '/') {
+        return 0;
+    }
+
+    char second = offset + 1 < len ? buff[offset + 1] : '\0';
+    char third = offset + 2 < len ? buff[offset + 2] : '\0';
+
+    *type = T_COMMENT;
+
+    if (first == '#' || (first == '-' && second == '-' && (unsigned char) third <= ' ')) {
+        const char *end = memchr(buff + offset, '\n', len - offset);
+
+        return (end == NULL ? len : (size_t) (end - buff)) - offset;
+    }
+
+    if (first != '/' || second != '*' || third == '!') {
+        return 0;
+    }
+
+    if (third == '+') {
+        *type = T_OPTIMIZER_HINT;
+    }
+
+    // The closing "/" needs a "*" in front which is not the one from the opening delimiter
+    for (size_t slash = offset + 3; slash < len; slash++) {
+        const char *end = memchr(buff + slash, '/', len - slash);
+
+        if (end == NULL) {
+            break;
+        }
+
+        slash = (size_t) (end - buff);
+
+        if (buff[slash - 1] == '*') {
+            return slash + 1 - offset;
+        }
+    }
+
+    *type = T_UNKNOWN;
+
+    return len - offset;
+}
+
+#endif //SQL_QUERY_PARSER_COMMENT_SCAN_H
@@ -1,7 +1,10 @@
 #ifndef SQL_QUERY_PARSER_TSQLP_H
 #define SQL_QUERY_PARSER_TSQLP_H
 
-#define API_VERSION 1
+/*
+ * Raised whenever a public struct changes its layout, version 2 added hints, subqueries and the AST to the parse result
+ */
+#define API_VERSION 2
 
 #include <stdio.h>
 
@@ -9,19 +12,203 @@ typedef enum {
     TSQLP_PARSE_OK = 32000,
     TSQLP_PARSE_ERROR_INVALID_ARGUMENT = 32001,
     TSQLP_PARSE_INVALID_SYNTAX = 32002,
+    TSQLP_PARSE_INVALID_UTF8 = 32003,
+    TSQLP_PARSE_NESTING_TOO_DEEP = 32004,
+    // Grammar rejected the statement and its sections come from the shallow scan fallback
+    TSQLP_PARSE_SHALLOW = 32005,
+    // Event callback asked to stop, see tsqlp_parse_events()
+    TSQLP_PARSE_ABORTED = 32006,
+    // Result does not fit the buffer passed to tsqlp_parse_into()
+    TSQLP_PARSE_BUFFER_TOO_SMALL = 32007,
 } tsqlp_parse_status;
 
+/*
+ * Nesting allowed by default, see tsqlp_parse_result_set_max_depth(). Each level takes roughly 300 bytes of stack in
+ * optimized builds and twice that without optimizations.
+ */
+#define TSQLP_DEFAULT_MAX_DEPTH 256
+
+/*
+ * Sections of a statement, combined into the mask passed to tsqlp_parse_result_set_sections()
+ */
+typedef enum {
+    TSQLP_SECTION_MODIFIERS = 1 << 0,
+    TSQLP_SECTION_COLUMNS = 1 << 1,
+    TSQLP_SECTION_FIRST_INTO = 1 << 2,
+    TSQLP_SECTION_TABLES = 1 << 3,
+    TSQLP_SECTION_WHERE = 1 << 4,
+    TSQLP_SECTION_GROUP_BY = 1 << 5,
+    TSQLP_SECTION_HAVING = 1 << 6,
+    TSQLP_SECTION_ORDER_BY = 1 << 7,
+    TSQLP_SECTION_LIMIT = 1 << 8,
+    TSQLP_SECTION_PROCEDURE = 1 << 9,
+    TSQLP_SECTION_SECOND_INTO = 1 << 10,
+    TSQLP_SECTION_FLAGS = 1 << 11,
+} tsqlp_section;
+
+#define TSQLP_SECTION_ALL 0xfff
+
+typedef enum {
+    TSQLP_TOKEN_WHITE_SPACE,
+    TSQLP_TOKEN_COMMENT,
+    TSQLP_TOKEN_OPTIMIZER_HINT,
+    TSQLP_TOKEN_KEYWORD,
+    TSQLP_TOKEN_IDENTIFIER,
+    TSQLP_TOKEN_QUALIFIED_IDENTIFIER,
+    TSQLP_TOKEN_WILDCARD_IDENTIFIER,
+    TSQLP_TOKEN_VARIABLE,
+    TSQLP_TOKEN_STRING,
+    TSQLP_TOKEN_NUMBER,
+    TSQLP_TOKEN_HEX_VALUE,
+    TSQLP_TOKEN_BIT_VALUE,
+    TSQLP_TOKEN_PLACEHOLDER,
+    TSQLP_TOKEN_OPERATOR,
+    TSQLP_TOKEN_COMMA,
+    TSQLP_TOKEN_OPEN_PAREN,
+    TSQLP_TOKEN_CLOSE_PAREN,
+    TSQLP_TOKEN_UNKNOWN,
+} tsqlp_token_type;
+
+/*
+ * Token located by its offset within the statement and its length in bytes
+ */
+struct tsqlp_token {
+    tsqlp_token_type type;
+    size_t offset;
+    size_t len;
+};
+
+/*
+ * Where a statement failed with TSQLP_PARSE_INVALID_SYNTAX. Token is the one parsing stopped at, empty with offset at
+ * the length of the statement when the statement ended too early. Expected is the class of the token which was
+ * required instead, or TSQLP_TOKEN_UNKNOWN when several kinds of tokens could have followed.
+ */
+struct tsqlp_syntax_error {
+    struct tsqlp_token token;
+    tsqlp_token_type expected;
+};
+
+typedef enum {
+    TSQLP_EVENT_SECTION_START,
+    TSQLP_EVENT_SECTION_END,
+    TSQLP_EVENT_PLACEHOLDER,
+    TSQLP_EVENT_IDENTIFIER,
+    TSQLP_EVENT_LITERAL,
+    TSQLP_EVENT_SUBQUERY_START,
+    TSQLP_EVENT_SUBQUERY_END,
+} tsqlp_event_type;
+
+/*
+ * Reported by tsqlp_parse_events() in statement order. Section is the TSQLP_SECTION_* flag of the section starting,
+ * ending or holding the event, and depth is the number of subqueries the event is nested in, 0 for the top level
+ * statement. Token is the placeholder, identifier or literal itself. Sections and subqueries are reported with the
+ * offset of their first token and a length of 0 when they start, and with their whole length when they end.
+ */
+struct tsqlp_event {
+    tsqlp_event_type type;
+    unsigned int section;
+    unsigned int depth;
+    struct tsqlp_token token;
+};
+
+/*
+ * Returns 0 to continue parsing, anything else aborts it
+ */
+typedef int (*tsqlp_event_callback)(const struct tsqlp_event *event, void *user_data);
+
+struct tsqlp_tokenizer;
+
+struct tsqlp_parser;
+
 struct tsqlp_placeholders {
     size_t *locations;
     size_t count;
 };
 
 struct tsqlp_sql_section {
-    char *chunk;
+    const char *chunk;
     size_t len;
     struct tsqlp_placeholders placeholders;
 };
 
+/*
+ * Optimizer hint comments, each located by its offset within the statement and its length, both including the
+ * comment delimiters
+ */
+struct tsqlp_hints {
+    size_t *locations;
+    size_t *lengths;
+    size_t count;
+};
+
+struct tsqlp_subquery;
+
+/*
+ * SELECT statements nested directly in the sections of a statement, in order of appearance
+ */
+struct tsqlp_subqueries {
+    struct tsqlp_subquery *items;
+    size_t count;
+};
+
+typedef enum {
+    // SELECT statement, its children are its sections
+    TSQLP_AST_STATEMENT,
+    // Non-empty section, its children are the expressions and tables in it
+    TSQLP_AST_SECTION,
+    TSQLP_AST_LITERAL,
+    TSQLP_AST_IDENTIFIER,
+    TSQLP_AST_VARIABLE,
+    TSQLP_AST_PLACEHOLDER,
+    // Function name followed by the arguments as children
+    TSQLP_AST_FUNCTION,
+    // Prefix operator and its operand
+    TSQLP_AST_UNARY_OPERATOR,
+    // Operands of an infix operator, or of IS, BETWEEN, LIKE ... ESCAPE, IN and COLLATE, the operator follows the first
+    TSQLP_AST_OPERATOR,
+    // Parenthesized expressions, a subquery or a list of tables, also with ROW in front
+    TSQLP_AST_LIST,
+    // Expressions of CASE in order, the operand, each WHEN and THEN and the ELSE
+    TSQLP_AST_CASE,
+    TSQLP_AST_INTERVAL,
+    TSQLP_AST_EXISTS,
+    // Columns followed by the expression searched for
+    TSQLP_AST_MATCH,
+    // Table name or placeholder, its alias and its index hints
+    TSQLP_AST_TABLE,
+    // Subquery, its alias and its column names
+    TSQLP_AST_DERIVED_TABLE,
+    // Left table or join, right table and the ON expression or USING columns
+    TSQLP_AST_JOIN,
+    // Alias of the node right before it, only the alias name
+    TSQLP_AST_ALIAS,
+    // USE, FORCE or IGNORE INDEX and the index names
+    TSQLP_AST_INDEX_HINT,
+} tsqlp_ast_node_type;
+
+/*
+ * Node located by the offset of its first token within the statement and the length up to the end of its last token.
+ * Its children are nodes[first_child] to nodes[first_child + child_count - 1] of the same AST. Section is the
+ * TSQLP_SECTION_* flag of a TSQLP_AST_SECTION node and 0 for the others.
+ */
+struct tsqlp_ast_node {
+    tsqlp_ast_node_type type;
+    unsigned int section;
+    size_t offset;
+    size_t len;
+    size_t first_child;
+    size_t child_count;
+};
+
+/*
+ * Nodes of the whole statement, subqueries included, with the children of every node stored next to each other and
+ * before the node itself, so the root statement is the last node
+ */
+struct tsqlp_ast {
+    struct tsqlp_ast_node *nodes;
+    size_t count;
+};
+
 struct tsqlp_parse_result {
     struct tsqlp_sql_section modifiers;
     struct tsqlp_sql_section columns;
@@ -35,12 +222,120 @@ struct tsqlp_parse_result {
     struct tsqlp_sql_section procedure;
     struct tsqlp_sql_section second_into;
     struct tsqlp_sql_section flags;
+    struct tsqlp_hints hints;
+    struct tsqlp_subqueries subqueries;
+    struct tsqlp_ast ast;
+};
+
+/*
+ * Subquery located by its offset within the whole statement and its length, without the parentheses around it. Its
+ * result holds its own sections, with placeholders relative to each of them, and the subqueries nested in it. It has
+ * no hints, those are collected by the top level result, and it is owned by the top level result, so it must not be
+ * freed nor parsed into.
+ */
+struct tsqlp_subquery {
+    size_t offset;
+    size_t len;
+    struct tsqlp_parse_result *parse_result;
 };
 
+/*
+ * Section contents, placeholders and hints are allocated from an arena which lives in the same allocation as the
+ * result and is released by tsqlp_parse_result_free() all at once. Results passed to tsqlp_parse() must come from here.
+ */
 struct tsqlp_parse_result *tsqlp_parse_result_new();
 
+/*
+ * Like tsqlp_parse_result_new(), but section contents point into the statement passed to tsqlp_parse() instead of being
+ * copied, so the statement has to outlive the result and section contents are not NUL terminated
+ */
+struct tsqlp_parse_result *tsqlp_parse_result_new_with_views();
+
+/*
+ * Limits how deep expressions and subqueries parsed into this result can nest, deeper statements fail with
+ * TSQLP_PARSE_NESTING_TOO_DEEP instead of exhausting the stack. Parentheses, function arguments, operands of unary
+ * operators, operands binding tighter than the operator before them and subqueries each add a level, while chains of
+ * operators of the same precedence do not.
+ */
+void tsqlp_parse_result_set_max_depth(struct tsqlp_parse_result *parse_result, unsigned int max_depth);
+
+/*
+ * Limits parsing into this result to a mask of TSQLP_SECTION_* flags, TSQLP_SECTION_ALL by default. Other sections,
+ * in subqueries as well, are still parsed but left empty and their subqueries are not recorded. Parsing stops once the
+ * last requested section of the statement is done, so the rest of the statement is not checked and its hints are not
+ * collected, and a statement which is only valid up to there parses successfully.
+ */
+void tsqlp_parse_result_set_sections(struct tsqlp_parse_result *parse_result, unsigned int sections);
+
+/*
+ * Finds the sections without checking the grammar, by splitting the statement at the clause keywords found outside of
+ * parentheses, and collects the placeholders of each of them. Much faster than tsqlp_parse() but best effort: a
+ * statement is only rejected when it does not start with SELECT, ends with a clause keyword, has unbalanced
+ * parentheses or an unknown token, and no subqueries are recorded.
+ */
+tsqlp_parse_status tsqlp_parse_shallow(const char *sql, size_t len, struct tsqlp_parse_result *parse_result);
+
+/*
+ * When enabled, statements which the grammar rejects are scanned again with tsqlp_parse_shallow(), and the parse
+ * returns TSQLP_PARSE_SHALLOW if that finds the sections. Disabled by default.
+ */
+void tsqlp_parse_result_set_shallow_fallback(struct tsqlp_parse_result *parse_result, int is_enabled);
+
+/*
+ * When enabled, a successful tsqlp_parse() also builds the AST of the statement, see tsqlp_parse_result_ast(). Nodes
+ * live in the arena of the result, so building them costs a few copies of each node and no extra allocations once the
+ * arena has grown. Disabled by default.
+ */
+void tsqlp_parse_result_set_ast(struct tsqlp_parse_result *parse_result, int is_enabled);
+
+/*
+ * Parses a statement into parse_result. A result can be reused, everything the previous parse put into it is dropped
+ * first, including its section contents and subqueries, while its options are kept.
+ */
 tsqlp_parse_status tsqlp_parse(const char *sql, size_t len, struct tsqlp_parse_result *parse_result);
 
+/*
+ * Checks the statement with the same grammar as tsqlp_parse(), with the default nesting limit, without extracting any
+ * section. Nothing is allocated with the default table scanner. When placeholder_count is not NULL, it receives the
+ * number of placeholders of a valid statement, subqueries included, and 0 otherwise.
+ */
+tsqlp_parse_status tsqlp_validate(const char *sql, size_t len, size_t *placeholder_count);
+
+/*
+ * Checks the statement like tsqlp_validate() and calls callback while parsing, for non-empty sections, placeholders,
+ * identifiers of columns, functions and tables, literals and subqueries. Events already reported stand even when
+ * parsing fails later on. Fails with TSQLP_PARSE_ABORTED as soon as the callback returns non-zero.
+ */
+tsqlp_parse_status
+tsqlp_parse_events(const char *sql, size_t len, tsqlp_event_callback callback, void *user_data);
+
+/*
+ * Parses like tsqlp_parse() with a result of the default settings, which is laid out together with its sections,
+ * placeholders, hints and subqueries in the cap bytes at buf, at any alignment, so nothing is allocated with the
+ * default table scanner. On return parse_result points into buf, or is NULL when the result could not be placed
+ * there, and must not be passed to tsqlp_parse_result_free(), the result is gone once buf is reused.
+ *
+ * required receives the size of buffer the statement needs. When the result of a statement the grammar accepts does
+ * not fit, or when buf can not hold even the result itself, the parse fails with TSQLP_PARSE_BUFFER_TOO_SMALL and a
+ * buffer of required bytes is enough to parse the statement again. Other failures are reported as by tsqlp_parse().
+ */
+tsqlp_parse_status tsqlp_parse_into(const char *sql, size_t len, void *buf, size_t cap,
+                                    struct tsqlp_parse_result **parse_result, size_t *required);
+
+/*
+ * Buffer size which tsqlp_parse_into() never outgrows for any statement of len bytes. Placeholders and sections are
+ * recorded again for every subquery holding them, so the bound grows with the nesting a statement of that length can
+ * reach, up to TSQLP_DEFAULT_MAX_DEPTH levels, and flat statements need far less.
+ */
+size_t tsqlp_parse_into_bound(size_t len);
+
+/*
+ * Returns 1 and fills syntax_error when the grammar rejected the last statement parsed into this result, which then
+ * failed with TSQLP_PARSE_INVALID_SYNTAX or fell back to TSQLP_PARSE_SHALLOW, 0 otherwise. The position is only
+ * worked out once parsing failed, successful parses do not pay for it.
+ */
+int tsqlp_parse_result_syntax_error(struct tsqlp_parse_result *parse_result, struct tsqlp_syntax_error *syntax_error);
+
 void tsqlp_parse_result_free(struct tsqlp_parse_result *parse_result);
 
 const char *tsqlp_parse_status_to_message(tsqlp_parse_status parse_status);
@@ -59,6 +354,95 @@ size_t tsqlp_sql_section_length(const struct tsqlp_sql_section *sql_section);
 
 const char *tsqlp_sql_section_content(const struct tsqlp_sql_section *sql_section);
 
+struct tsqlp_hints *tsqlp_parse_result_hints(struct tsqlp_parse_result *parse_result);
+
+int tsqlp_hints_count(const struct tsqlp_hints *hints);
+
+size_t tsqlp_hints_position_at(const struct tsqlp_hints *hints, unsigned int index);
+
+size_t tsqlp_hints_length_at(const struct tsqlp_hints *hints, unsigned int index);
+
+struct tsqlp_subqueries *tsqlp_parse_result_subqueries(struct tsqlp_parse_result *parse_result);
+
+int tsqlp_subqueries_count(const struct tsqlp_subqueries *subqueries);
+
+/*
+ * Returns NULL when index is out of range
+ */
+struct tsqlp_subquery *tsqlp_subqueries_at(const struct tsqlp_subqueries *subqueries, unsigned int index);
+
+/*
+ * AST of the last successful parse when tsqlp_parse_result_set_ast() is enabled, empty otherwise. It covers what was
+ * parsed, so it ends with the last requested section, and it is empty for subquery results, whose statements are nodes
+ * of the top level AST.
+ */
+struct tsqlp_ast *tsqlp_parse_result_ast(struct tsqlp_parse_result *parse_result);
+
+int tsqlp_ast_count(const struct tsqlp_ast *ast);
+
+/*
+ * Returns NULL when index is out of range
+ */
+struct tsqlp_ast_node *tsqlp_ast_at(const struct tsqlp_ast *ast, unsigned int index);
+
+/*
+ * Long-lived parser for parsing statements one after another, for example one parser per worker thread. The scanner,
+ * its buffers and the result are kept between parses, so once they have grown to fit the statements parsing does not
+ * allocate. Returns NULL on allocation failure.
+ */
+struct tsqlp_parser *tsqlp_parser_new();
+
+/*
+ * Like tsqlp_parser_new(), but the result holds section views as with tsqlp_parse_result_new_with_views()
+ */
+struct tsqlp_parser *tsqlp_parser_new_with_views();
+
+/*
+ * Parses into the parser's result, replacing the result of the previous parse
+ */
+tsqlp_parse_status tsqlp_parser_parse(struct tsqlp_parser *parser, const char *sql, size_t len);
+
+/*
+ * Same as tsqlp_parse_result_set_max_depth() for the parser's result
+ */
+void tsqlp_parser_set_max_depth(struct tsqlp_parser *parser, unsigned int max_depth);
+
+/*
+ * Same as tsqlp_parse_result_set_sections() for the parser's result
+ */
+void tsqlp_parser_set_sections(struct tsqlp_parser *parser, unsigned int sections);
+
+/*
+ * Same as tsqlp_parse_result_set_shallow_fallback() for the parser's result
+ */
+void tsqlp_parser_set_shallow_fallback(struct tsqlp_parser *parser, int is_enabled);
+
+/*
+ * Same as tsqlp_parse_result_set_ast() for the parser's result
+ */
+void tsqlp_parser_set_ast(struct tsqlp_parser *parser, int is_enabled);
+
+/*
+ * Result of the last parse, owned by the parser and valid until its next parse
+ */
+struct tsqlp_parse_result *tsqlp_parser_result(struct tsqlp_parser *parser);
+
+void tsqlp_parser_free(struct tsqlp_parser *parser);
+
+/*
+ * Iterates over the tokens tsqlp_parse() would see, produced by the same scanner, including whitespace and comments so
+ * that the tokens cover the whole statement. The statement is not checked to be valid UTF-8 and scanning does not stop
+ * at unknown tokens. Returns NULL when sql is NULL or on allocation failure.
+ */
+struct tsqlp_tokenizer *tsqlp_tokenizer_new(const char *sql, size_t len);
+
+/*
+ * Stores the next token and returns 1, or returns 0 at the end of the statement
+ */
+int tsqlp_tokenizer_next(struct tsqlp_tokenizer *tokenizer, struct tsqlp_token *token);
+
+void tsqlp_tokenizer_free(struct tsqlp_tokenizer *tokenizer);
+
 unsigned int tsqlp_api_version();
 
 #endif //SQL_QUERY_PARSER_TSQLP_H
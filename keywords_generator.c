@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*
+ * Build time generator of the keyword lookup used by the table scanner.
+ *
+ * Keywords are collected from the T_K_* members of sql_token_type in lexer.h and interval units are appended to
+ * them. A seed is searched for which the hash below maps every word into a distinct slot, so a lookup costs one hash
+ * and at most one comparison.
+ *
+ * Usage: keywords_generator <lexer.h> <output header>
+ */
+
+#define MAX_WORDS 1024
+#define MAX_WORD_LEN 64
+#define MAX_SEED_ATTEMPTS 100000
+
+static const char *interval_units[] = {
+    "YEAR_MONTH", "YEAR", "WEEK", "SECOND_MICROSECOND", "SECOND", "QUARTER", "MONTH", "MINUTE_SECOND",
+    "MINUTE_MICROSECOND", "MINUTE", "MICROSECOND", "HOUR_SECOND", "HOUR_MINUTE", "HOUR_MICROSECOND", "HOUR",
+    "DAY_SECOND", "DAY_MINUTE", "DAY_MICROSECOND", "DAY_HOUR", "DAY"
+};
+
+struct word {
+    char text[MAX_WORD_LEN];
+    size_t len;
+    const char *type;
+};
+
+/*
+ * Must stay in sync with the keyword_slot() emitted below. Letters are folded to upper case with a mask, which maps
+ * no other identifier byte onto a letter or "_".
+ */
+static uint32_t keyword_hash(const char *word, size_t len, uint32_t seed) {
+    uint32_t hash = seed ^ (uint32_t) len;
+
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (unsigned char) (word[i] & ~0x20)) * 0x01000193u;
+    }
+
+    return hash ^ (hash >> 15);
+}
+
+static char *read_file(const char *path) {
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *content = malloc((size_t) size + 1);
+
+    if (content == NULL || fread(content, 1, (size_t) size, file) != (size_t) size) {
+        fclose(file);
+        free(content);
+
+        return NULL;
+    }
+
+    content[size] = '\0';
+    fclose(file);
+
+    return content;
+}
+
+static int is_word_char(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static size_t collect_keywords(const char *header, struct word *words) {
+    size_t count = 0;
+    const char *enum_end = strstr(header, "} sql_token_type;");
+
+    for (const char *cursor = strstr(header, "T_K_"); cursor != NULL && cursor < enum_end; cursor = strstr(cursor, "T_K_")) {
+        cursor += 4;
+
+        size_t len = 0;
+
+        while (is_word_char(cursor[len])) {
+            len++;
+        }
+
+        if (len == 0 || len >= MAX_WORD_LEN || count == MAX_WORDS) {
+            fprintf(stderr, "Unsupported keyword near %.20s\n", cursor);
+            exit(1);
+        }
+
+        memcpy(words[count].text, cursor, len);
+        words[count].text[len] = '\0';
+        words[count].len = len;
+        words[count].type = NULL;
+        count++;
+        cursor += len;
+    }
+
+    return count;
+}
+
+static int find_seed(const struct word *words, size_t count, size_t slots_count, uint32_t *seed) {
+    unsigned char *used = malloc(slots_count);
+
+    if (used == NULL) {
+        exit(2);
+    }
+
+    for (uint32_t candidate = 0; candidate < MAX_SEED_ATTEMPTS; candidate++) {
+        size_t i = 0;
+
+        memset(used, 0, slots_count);
+
+        for (; i < count; i++) {
+            size_t slot = keyword_hash(words[i].text, words[i].len, candidate) & (slots_count - 1);
+
+            if (used[slot]) {
+                break;
+            }
+
+            used[slot] = 1;
+        }
+
+        if (i == count) {
+            free(used);
+            *seed = candidate;
+
+            return 1;
+        }
+    }
+
+    free(used);
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <lexer.h> <output header>\n", argv[0]);
+
+        return 1;
+    }
+
+    char *header = read_file(argv[1]);
+
+    if (header == NULL) {
+        fprintf(stderr, "Unable to read %s\n", argv[1]);
+
+        return 1;
+    }
+
+    static struct word words[MAX_WORDS];
+    size_t count = collect_keywords(header, words);
+
+    free(header);
+
+    if (count + sizeof(interval_units) / sizeof(interval_units[0]) > MAX_WORDS) {
+        fprintf(stderr, "Too many keywords\n");
+
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(interval_units) / sizeof(interval_units[0]); i++, count++) {
+        strcpy(words[count].text, interval_units[i]);
+        words[count].len = strlen(interval_units[i]);
+        words[count].type = "T_INTERVAL_UNIT";
+    }
+
+    size_t max_len = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        max_len = words[i].len > max_len ? words[i].len : max_len;
+    }
+
+    size_t slots_count = 64;
+    uint32_t seed;
+
+    while (slots_count < count * 2 || !find_seed(words, count, slots_count, &seed)) {
+        slots_count *= 2;
+    }
+
+    FILE *output = fopen(argv[2], "w");
+
+    if (output == NULL) {
+        fprintf(stderr, "Unable to write %s\n", argv[2]);
+
+        return 1;
+    }
+
+    fprintf(output, "/* Generated by keywords_generator from lexer.h, do not edit */\n\n");
+    fprintf(output, "#define KEYWORD_MAX_LEN %zu\n", max_len);
+    fprintf(output, "#define KEYWORD_SLOTS_MASK %zuu\n", slots_count - 1);
+    fprintf(output, "#define KEYWORD_HASH_SEED %uu\n\n", (unsigned int) seed);
+
+    fprintf(output, "static const struct {\n    const char *word;\n    size_t len;\n    sql_token_type type;\n} keyword_words[] = {\n");
+    fprintf(output, "    {\"\", 0, T_IDENTIFIER},\n");
+
+    for (size_t i = 0; i < count; i++) {
+        if (words[i].type == NULL) {
+            fprintf(output, "    {\"%s\", %zu, T_K_%s},\n", words[i].text, words[i].len, words[i].text);
+        } else {
+            fprintf(output, "    {\"%s\", %zu, %s},\n", words[i].text, words[i].len, words[i].type);
+        }
+    }
+
+    fprintf(output, "};\n\n");
+
+    size_t *slots = calloc(slots_count, sizeof(size_t));
+
+    if (slots == NULL) {
+        exit(2);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        slots[keyword_hash(words[i].text, words[i].len, seed) & (slots_count - 1)] = i + 1;
+    }
+
+    fprintf(output, "static const %s keyword_slots[%zu] = {", count < 255 ? "unsigned char" : "unsigned short", slots_count);
+
+    for (size_t i = 0; i < slots_count; i++) {
+        fprintf(output, "%s%zu,", i % 16 == 0 ? "\n    " : " ", slots[i]);
+    }
+
+    fprintf(output, "\n};\n\n");
+    free(slots);
+
+    fprintf(output,
+        "static size_t keyword_slot(const char *word, size_t len) {\n"
+        "    uint32_t hash = KEYWORD_HASH_SEED ^ (uint32_t) len;\n"
+        "\n"
+        "    for (size_t i = 0; i < len; i++) {\n"
+        "        hash = (hash ^ (unsigned char) (word[i] & ~0x20)) * 0x01000193u;\n"
+        "    }\n"
+        "\n"
+        "    return (hash ^ (hash >> 15)) & KEYWORD_SLOTS_MASK;\n"
+        "}\n"
+        "\n"
+        "static sql_token_type keyword_type(const char *word, size_t len) {\n"
+        "    if (len > KEYWORD_MAX_LEN) {\n"
+        "        return T_IDENTIFIER;\n"
+        "    }\n"
+        "\n"
+        "    size_t index = keyword_slots[keyword_slot(word, len)];\n"
+        "\n"
+        "    if (keyword_words[index].len != len) {\n"
+        "        return T_IDENTIFIER;\n"
+        "    }\n"
+        "\n"
+        "    for (size_t i = 0; i < len; i++) {\n"
+        "        if ((word[i] & ~0x20) != keyword_words[index].word[i]) {\n"
+        "            return T_IDENTIFIER;\n"
+        "        }\n"
+        "    }\n"
+        "\n"
+        "    return keyword_words[index].type;\n"
+        "}\n"
+    );
+
+    if (fclose(output) != 0) {
+        fprintf(stderr, "Unable to write %s\n", argv[2]);
+
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,3 +1,5 @@
+#include <stdlib.h>
+
 #include "lexer.h"
 
 int token_is_of_type(sql_token_type type, const struct token *token) {
@@ -31,13 +33,51 @@ static void lexer_ensure_have_current(struct lexer *lexer);
 static void lexer_ensure_have_next(struct lexer *lexer);
 
 
-extern void lexer_use_buffer(const char *buff, size_t len);
+extern void *lexer_reuse_buffer(void *scanner, const char *buff, size_t len);
+
+extern void *lexer_place_buffer(void *memory, size_t size, const char *buff, size_t len);
+
+static void lexer_push_hint(struct lexer *lexer, const struct token *token) {
+    if (lexer->hints.count == lexer->hints.capacity) {
+        size_t capacity = lexer->hints.capacity > 0 ? lexer->hints.capacity * 2 : 4;
+
+        if (lexer->hints_arena != NULL) {
+            size_t size = lexer->hints.count * sizeof(size_t);
+
+            lexer->hints.positions = tsqlp_arena_grow(lexer->hints_arena, lexer->hints.positions, size,
+                                                      capacity * sizeof(size_t));
+            lexer->hints.lengths = tsqlp_arena_grow(lexer->hints_arena, lexer->hints.lengths, size,
+                                                    capacity * sizeof(size_t));
+        } else {
+            lexer->hints.positions = realloc(lexer->hints.positions, capacity * sizeof(size_t));
+            lexer->hints.lengths = realloc(lexer->hints.lengths, capacity * sizeof(size_t));
+        }
+
+        lexer->hints.capacity = capacity;
+
+        if (lexer->hints.positions == NULL || lexer->hints.lengths == NULL) {
+            exit(2);
+        }
+    }
+
+    lexer->hints.positions[lexer->hints.count] = token->position;
+    lexer->hints.lengths[lexer->hints.count] = token->len;
+    lexer->hints.count++;
+}
 
 #define READ_NEXT_TOKEN(token) \
     do { \
         do { \
-            token = lexer_lex(); \
-        } while (token_is_of_type(T_WHITE_SPACE, &token)); \
+            token = lexer_lex(lexer->scanner); \
+            \
+            if (token_is_of_type(T_OPTIMIZER_HINT, &token) && (!lexer->is_static || lexer->hints_arena != NULL)) { \
+                lexer_push_hint(lexer, &token); \
+            } \
+        } while ( \
+            token_is_of_type(T_WHITE_SPACE, &token) \
+            || token_is_of_type(T_COMMENT, &token) \
+            || token_is_of_type(T_OPTIMIZER_HINT, &token) \
+        ); \
          \
         if (token_is_of_type(T_UNKNOWN, &token)) { \
             lexer->is_done = 1; \
@@ -62,12 +102,19 @@ static void lexer_ensure_have_current(struct lexer *lexer) {
 }
 
 static void lexer_ensure_have_next(struct lexer *lexer) {
-    if (lexer->has_next || lexer->is_done) {
+    if (lexer->has_next) {
         return;
     }
 
     lexer_ensure_have_current(lexer);
 
+    // Past the final T_EOF or T_UNKNOWN the same token is read again, like with the token array
+    if (lexer->is_done) {
+        lexer->next = lexer->current;
+
+        return;
+    }
+
     struct token token;
 
     READ_NEXT_TOKEN(token);
@@ -76,72 +123,326 @@ static void lexer_ensure_have_next(struct lexer *lexer) {
     lexer->has_next = 1;
 }
 
-struct lexer lexer_new(const char *buff, size_t len) {
-    lexer_use_buffer(buff, len);
-
-    struct lexer lexer = (struct lexer) {
-        .current = token_new(T_UNKNOWN, NULL, 0, 0),
-        .has_current = 0,
-        .previous = token_new(T_UNKNOWN, NULL, 0, 0),
-        .has_previous = 0,
-        .next = token_new(T_UNKNOWN, NULL, 0, 0),
-        .has_next = 0,
-        .is_done = 0,
-        .context = {
-            .buff = buff,
-            .len = len
-        },
-        .tokens_consumed = 0
+extern void lexer_clear_buffer(void *scanner);
+
+#ifdef TSQLP_TOKEN_ARRAY
+
+/*
+ * Positions, lengths and types share one allocation, in that order so that every array stays aligned. A block left
+ * from a previous query is used as long as it has the capacity.
+ */
+static void lexer_tokens_reserve(struct lexer *lexer, size_t capacity) {
+    char *block = lexer->tokens.block;
+
+    if (capacity <= lexer->tokens.capacity) {
+        capacity = lexer->tokens.capacity;
+    } else {
+        block = malloc(capacity * (2 * sizeof(uint32_t) + sizeof(unsigned char)));
+
+        if (block == NULL) {
+            exit(2);
+        }
+    }
+
+    uint32_t *positions = (uint32_t *) block;
+    uint32_t *lengths = positions + capacity;
+    unsigned char *types = (unsigned char *) (lengths + capacity);
+
+    if (lexer->tokens.count > 0 && block != lexer->tokens.block) {
+        memcpy(positions, lexer->tokens.positions, lexer->tokens.count * sizeof(uint32_t));
+        memcpy(lengths, lexer->tokens.lengths, lexer->tokens.count * sizeof(uint32_t));
+        memcpy(types, lexer->tokens.types, lexer->tokens.count * sizeof(unsigned char));
+    }
+
+    if (block != lexer->tokens.block) {
+        free(lexer->tokens.block);
+    }
+
+    lexer->tokens.block = block;
+    lexer->tokens.capacity = capacity;
+    lexer->tokens.positions = positions;
+    lexer->tokens.lengths = lengths;
+    lexer->tokens.types = types;
+}
+
+// Tokens past the end read as the final T_EOF or T_UNKNOWN
+static size_t lexer_token_index(const struct lexer *lexer, size_t index) {
+    return index < lexer->tokens.count ? index : lexer->tokens.count - 1;
+}
+
+static struct token lexer_token_at(const struct lexer *lexer, size_t index) {
+    index = lexer_token_index(lexer, index);
+
+    size_t position = lexer->tokens.positions[index];
+    sql_token_type type = (sql_token_type) lexer->tokens.types[index];
+
+    return token_new(type, type == T_EOF ? NULL : lexer->context.buff + position, lexer->tokens.lengths[index], position);
+}
+
+static void lexer_tokenize(struct lexer *lexer) {
+    struct token token;
+
+    // Most tokens are separated by whitespace, so this rarely needs to grow
+    lexer_tokens_reserve(lexer, lexer->context.len / 4 + 16);
+
+    do {
+        READ_NEXT_TOKEN(token);
+
+        if (lexer->tokens.count == lexer->tokens.capacity) {
+            lexer_tokens_reserve(lexer, lexer->tokens.capacity * 2);
+        }
+
+        lexer->tokens.types[lexer->tokens.count] = (unsigned char) token.type;
+        lexer->tokens.positions[lexer->tokens.count] = (uint32_t) token.position;
+        lexer->tokens.lengths[lexer->tokens.count] = (uint32_t) token.len;
+        lexer->tokens.count++;
+    } while (!lexer->is_done);
+}
+
+#endif
+
+// Lexer without a scanner or buffers, set up by lexer_reset()
+static struct lexer lexer_new_empty() {
+    return (struct lexer) {
+        .scanner = NULL,
+        .owns_scanner = 1,
+        .is_static = 0,
+        .hints_arena = NULL,
+        .hints = {
+            .positions = NULL,
+            .lengths = NULL,
+            .count = 0,
+            .capacity = 0
+        }
+#ifdef TSQLP_TOKEN_ARRAY
+        ,
+        .tokens = {
+            .types = NULL,
+            .positions = NULL,
+            .lengths = NULL,
+            .count = 0,
+            .block = NULL,
+            .capacity = 0
+        }
+#endif
     };
+}
+
+struct lexer lexer_new(const char *buff, size_t len) {
+    struct lexer lexer = lexer_new_empty();
+
+    lexer_reset(&lexer, buff, len);
 
     return lexer;
 }
 
+void lexer_init_static(struct lexer *lexer, const char *buff, size_t len) {
+    *lexer = lexer_new_empty();
+    lexer->is_static = 1;
+    lexer->scanner = lexer_place_buffer(lexer->static_scanner, sizeof(lexer->static_scanner), buff, len);
+    lexer->owns_scanner = lexer->scanner == NULL;
+
+    lexer_reset(lexer, buff, len);
+}
+
+void lexer_collect_hints(struct lexer *lexer, struct tsqlp_arena *arena) {
+    lexer->hints_arena = arena;
+}
+
+void lexer_reset(struct lexer *lexer, const char *buff, size_t len) {
+    lexer->scanner = lexer_reuse_buffer(lexer->scanner, buff, len);
+    lexer->current = token_new(T_UNKNOWN, NULL, 0, 0);
+    lexer->has_current = 0;
+    lexer->previous = token_new(T_UNKNOWN, NULL, 0, 0);
+    lexer->has_previous = 0;
+    lexer->next = token_new(T_UNKNOWN, NULL, 0, 0);
+    lexer->has_next = 0;
+    lexer->is_done = 0;
+    lexer->context.buff = buff;
+    lexer->context.len = len;
+    lexer->tokens_consumed = 0;
+    lexer->hints.count = 0;
+    lexer->expected = T_UNKNOWN;
+
+#ifdef TSQLP_TOKEN_ARRAY
+    lexer->tokens.types = NULL;
+    lexer->tokens.positions = NULL;
+    lexer->tokens.lengths = NULL;
+    lexer->tokens.count = 0;
+
+    if (len <= UINT32_MAX && !lexer->is_static) {
+        lexer_tokenize(lexer);
+    }
+#endif
+}
+
 const char *lexer_buffer(const struct lexer *lexer) {
     return lexer->context.buff;
 }
 
-extern void lexer_clear_buffer();
+size_t lexer_buffer_length(const struct lexer *lexer) {
+    return lexer->context.len;
+}
 
 void lexer_destroy(struct lexer *lexer) {
-    lexer_clear_buffer();
+    if (lexer->hints_arena == NULL) {
+        free(lexer->hints.positions);
+        free(lexer->hints.lengths);
+    }
+
+#ifdef TSQLP_TOKEN_ARRAY
+    free(lexer->tokens.block);
+#endif
+
+    if (lexer->owns_scanner) {
+        lexer_clear_buffer(lexer->scanner);
+    }
 }
 
 size_t lexer_tokens_consumed(const struct lexer *lexer) {
     return lexer->tokens_consumed;
 }
 
-int lexer_has(struct lexer *lexer) {
-    lexer_ensure_have_current(lexer);
+const struct lexer_hints *lexer_hints(const struct lexer *lexer) {
+    return &lexer->hints;
+}
+
+void lexer_set_expected(struct lexer *lexer, sql_token_type type) {
+    lexer->expected = type;
+}
 
-    return lexer_peek(lexer)->type != T_EOF;
+sql_token_type lexer_expected(const struct lexer *lexer) {
+    return lexer->expected;
+}
+
+int lexer_has(struct lexer *lexer) {
+    return lexer_peek_type(lexer) != T_EOF;
 }
 
 const struct token *lexer_peek(struct lexer *lexer) {
+#ifdef TSQLP_TOKEN_ARRAY
+    // Only built when asked for, consuming just moves the cursor
+    if (lexer->tokens.types != NULL && !lexer->has_current) {
+        lexer->current = lexer_token_at(lexer, lexer->tokens_consumed);
+        lexer->has_current = 1;
+    }
+#endif
+
     lexer_ensure_have_current(lexer);
 
     return &lexer->current;
 }
 
 const struct token *lexer_peek_next(struct lexer *lexer) {
+#ifdef TSQLP_TOKEN_ARRAY
+    if (lexer->tokens.types != NULL) {
+        lexer->next = lexer_token_at(lexer, lexer->tokens_consumed + 1);
+
+        return &lexer->next;
+    }
+#endif
+
     lexer_ensure_have_next(lexer);
 
     return &lexer->next;
 }
 
 int lexer_has_previous(const struct lexer *lexer) {
+#ifdef TSQLP_TOKEN_ARRAY
+    if (lexer->tokens.types != NULL) {
+        return lexer->tokens_consumed > 0;
+    }
+#endif
+
     return lexer->has_previous;
 }
 
 int lexer_has_next(struct lexer *lexer) {
+#ifdef TSQLP_TOKEN_ARRAY
+    if (lexer->tokens.types != NULL) {
+        return lexer->tokens_consumed + 1 < lexer->tokens.count;
+    }
+#endif
+
     return lexer->has_next;
 }
 
-const struct token *lexer_peek_previous(const struct lexer *lexer) {
+const struct token *lexer_peek_previous(struct lexer *lexer) {
+#ifdef TSQLP_TOKEN_ARRAY
+    if (lexer->tokens.types != NULL && !lexer->has_previous && lexer->tokens_consumed > 0) {
+        lexer->previous = lexer_token_at(lexer, lexer->tokens_consumed - 1);
+        lexer->has_previous = 1;
+    }
+#endif
+
     return &lexer->previous;
 }
 
+sql_token_type lexer_peek_type(struct lexer *lexer) {
+#ifdef TSQLP_TOKEN_ARRAY
+    if (lexer->tokens.types != NULL) {
+        return (sql_token_type) lexer->tokens.types[lexer_token_index(lexer, lexer->tokens_consumed)];
+    }
+#endif
+
+    lexer_ensure_have_current(lexer);
+
+    return lexer->current.type;
+}
+
+size_t lexer_peek_position(struct lexer *lexer) {
+#ifdef TSQLP_TOKEN_ARRAY
+    if (lexer->tokens.types != NULL) {
+        return lexer->tokens.positions[lexer_token_index(lexer, lexer->tokens_consumed)];
+    }
+#endif
+
+    lexer_ensure_have_current(lexer);
+
+    return lexer->current.position;
+}
+
+size_t lexer_previous_end(const struct lexer *lexer) {
+#ifdef TSQLP_TOKEN_ARRAY
+    if (lexer->tokens.types != NULL) {
+        if (lexer->tokens_consumed == 0) {
+            return 0;
+        }
+
+        size_t index = lexer_token_index(lexer, lexer->tokens_consumed - 1);
+
+        return lexer->tokens.positions[index] + lexer->tokens.lengths[index];
+    }
+#endif
+
+    return token_position(&lexer->previous) + token_length(&lexer->previous);
+}
+
+void lexer_skip(struct lexer *lexer) {
+#ifdef TSQLP_TOKEN_ARRAY
+    if (lexer->tokens.types != NULL) {
+        lexer->tokens_consumed++;
+        lexer->has_current = 0;
+        lexer->has_previous = 0;
+
+        return;
+    }
+#endif
+
+    lexer_consume(lexer);
+}
+
 struct token lexer_consume(struct lexer *lexer) {
+#ifdef TSQLP_TOKEN_ARRAY
+    if (lexer->tokens.types != NULL) {
+        struct token token = lexer_token_at(lexer, lexer->tokens_consumed);
+
+        lexer_skip(lexer);
+
+        return token;
+    }
+#endif
+
     lexer_ensure_have_current(lexer);
 
     struct token token = lexer->current;
@@ -1,8 +1,11 @@
 #ifndef SQL_QUERY_PARSER_LEXER_H
 #define SQL_QUERY_PARSER_LEXER_H
 
+#include <stdint.h>
 #include <string.h>
 
+#include "arena.h"
+
 typedef enum {
     T_NUMBER,
     T_WHITE_SPACE,
@@ -27,6 +30,8 @@ typedef enum {
     T_VARIABLE,
     T_BIT_OR,
     T_BIT_AND,
+    T_COMMENT,
+    T_OPTIMIZER_HINT,
     T_LEFT_SHIFT,
     T_RIGHT_SHIFT,
     T_DIV,
@@ -142,7 +147,29 @@ struct token {
     size_t position;
 };
 
+struct lexer_hints {
+    size_t *positions;
+    size_t *lengths;
+    size_t count;
+    size_t capacity;
+};
+
+/*
+ * Room for the scanner of lexer_init_static(), enough for the table scanner
+ */
+#define LEXER_STATIC_SCANNER_WORDS 4
+
 struct lexer {
+    void *scanner;
+    // Scanner was allocated by the lexer, lexer_init_static() places it in static_scanner instead when it fits
+    int owns_scanner;
+    /*
+     * Set by lexer_init_static(), hints are not collected and tokens are lexed lazily so that nothing is allocated
+     */
+    int is_static;
+    // Arena the hints of a static lexer are collected in, see lexer_collect_hints()
+    struct tsqlp_arena *hints_arena;
+    size_t static_scanner[LEXER_STATIC_SCANNER_WORDS];
     struct token current;
     int has_current;
     struct token previous;
@@ -155,10 +182,50 @@ struct lexer {
         size_t len;
     } context;
     size_t tokens_consumed;
+    /*
+     * Optimizer hints skipped together with comments, in order of appearance
+     */
+    struct lexer_hints hints;
+    /*
+     * Token the parser required where it failed, T_UNKNOWN if it failed for another reason or did not fail
+     */
+    sql_token_type expected;
+#ifdef TSQLP_TOKEN_ARRAY
+    /*
+     * Whole input tokenized up front, whitespace excluded and the final T_EOF or T_UNKNOWN included. Consumed tokens
+     * are indexed by tokens_consumed. When the input does not fit 32-bit offsets types is NULL and tokens are lexed
+     * lazily instead.
+     */
+    struct {
+        unsigned char *types;
+        uint32_t *positions;
+        uint32_t *lengths;
+        size_t count;
+        // Allocation behind the arrays, kept by lexer_reset()
+        char *block;
+        size_t capacity;
+    } tokens;
+#endif
 };
 
 struct lexer lexer_new(const char *buff, size_t len);
 
+/*
+ * Sets up a lexer which does not allocate, as long as the scanner backend fits static_scanner. It points into itself,
+ * so it can not be copied.
+ */
+void lexer_init_static(struct lexer *lexer, const char *buff, size_t len);
+
+/*
+ * Makes a static lexer collect hints after all, growing them in arena instead of allocating them
+ */
+void lexer_collect_hints(struct lexer *lexer, struct tsqlp_arena *arena);
+
+/*
+ * Starts over on another query, keeping the scanner and buffers of the previous one
+ */
+void lexer_reset(struct lexer *lexer, const char *buff, size_t len);
+
 void lexer_destroy(struct lexer *lexer);
 
 int lexer_has(struct lexer *lexer);
@@ -167,18 +234,47 @@ int lexer_has_next(struct lexer *lexer);
 
 int lexer_has_previous(const struct lexer *lexer);
 
-const struct token *lexer_peek_previous(const struct lexer *lexer);
+const struct token *lexer_peek_previous(struct lexer *lexer);
 
 const char *lexer_buffer(const struct lexer *lexer);
 
+size_t lexer_buffer_length(const struct lexer *lexer);
+
 const struct token *lexer_peek(struct lexer *lexer);
 
 const struct token *lexer_peek_next(struct lexer *lexer);
 
 struct token lexer_consume(struct lexer *lexer);
 
+/*
+ * Type and offset of the current token, and the offset right past the last consumed one. With the token array they
+ * are read from it at the cursor, while lexer_peek() and lexer_peek_previous() first build the whole token.
+ */
+sql_token_type lexer_peek_type(struct lexer *lexer);
+
+size_t lexer_peek_position(struct lexer *lexer);
+
+size_t lexer_previous_end(const struct lexer *lexer);
+
+/*
+ * Consumes the current token without returning it, with the token array only the cursor moves
+ */
+void lexer_skip(struct lexer *lexer);
+
 size_t lexer_tokens_consumed(const struct lexer *lexer);
 
+/*
+ * Hints found so far, freed together with the lexer
+ */
+const struct lexer_hints *lexer_hints(const struct lexer *lexer);
+
+/*
+ * Records the token the parser required at the current one, only called on the way to a syntax error
+ */
+void lexer_set_expected(struct lexer *lexer, sql_token_type type);
+
+sql_token_type lexer_expected(const struct lexer *lexer);
+
 struct token token_new(sql_token_type type, const char *value, size_t len, size_t position);
 
 size_t token_position(const struct token *token);
@@ -189,6 +285,6 @@ sql_token_type token_type(const struct token *token);
 
 int token_is_of_type(sql_token_type type, const struct token *token);
 
-struct token lexer_lex();
+struct token lexer_lex(void *scanner);
 
 #endif //SQL_QUERY_PARSER_LEXER_H
@@ -0,0 +1,281 @@
+#include "lexer.h"
+#include "tsqlp.h"
+
+/*
+ * Sections in the order of the statement, which is also the order of the TSQLP_SECTION_* flags
+ */
+typedef enum {
+    SHALLOW_MODIFIERS,
+    SHALLOW_COLUMNS,
+    SHALLOW_FIRST_INTO,
+    SHALLOW_TABLES,
+    SHALLOW_WHERE,
+    SHALLOW_GROUP_BY,
+    SHALLOW_HAVING,
+    SHALLOW_ORDER_BY,
+    SHALLOW_LIMIT,
+    SHALLOW_PROCEDURE,
+    SHALLOW_SECOND_INTO,
+    SHALLOW_FLAGS
+} shallow_section;
+
+struct shallow_scan {
+    struct tsqlp_parse_result *parse_result;
+    struct tsqlp_arena *arena;
+    int use_views;
+    unsigned int sections;
+    shallow_section section;
+    // Section has no token yet, its start is the position of the first one
+    int is_empty;
+    size_t start;
+    size_t end;
+    // Placeholders of all sections, the ones of the current section start at section_start
+    struct tsqlp_placeholder_pool pool;
+    size_t section_start;
+};
+
+static struct tsqlp_sql_section *section_of(struct tsqlp_parse_result *parse_result, shallow_section section) {
+    switch (section) {
+        case SHALLOW_MODIFIERS:
+            return &parse_result->modifiers;
+        case SHALLOW_COLUMNS:
+            return &parse_result->columns;
+        case SHALLOW_FIRST_INTO:
+            return &parse_result->first_into;
+        case SHALLOW_TABLES:
+            return &parse_result->tables;
+        case SHALLOW_WHERE:
+            return &parse_result->where;
+        case SHALLOW_GROUP_BY:
+            return &parse_result->group_by;
+        case SHALLOW_HAVING:
+            return &parse_result->having;
+        case SHALLOW_ORDER_BY:
+            return &parse_result->order_by;
+        case SHALLOW_LIMIT:
+            return &parse_result->limit;
+        case SHALLOW_PROCEDURE:
+            return &parse_result->procedure;
+        case SHALLOW_SECOND_INTO:
+            return &parse_result->second_into;
+        default:
+            return &parse_result->flags;
+    }
+}
+
+static void shallow_scan_finish_section(struct shallow_scan *scan, const char *buff) {
+    if (scan->is_empty || !(scan->sections & (1u << scan->section))) {
+        return;
+    }
+
+    struct tsqlp_placeholders placeholders = tsqlp_placeholder_pool_slice(&scan->pool, scan->section_start);
+
+    if (scan->use_views) {
+        tsqlp_sql_section_view(buff + scan->start, scan->end - scan->start, placeholders,
+                               section_of(scan->parse_result, scan->section));
+    } else {
+        tsqlp_sql_section_update(buff + scan->start, scan->end - scan->start, placeholders,
+                                 section_of(scan->parse_result, scan->section), scan->arena);
+    }
+}
+
+static void shallow_scan_start_section(struct shallow_scan *scan, shallow_section section, const char *buff) {
+    shallow_scan_finish_section(scan, buff);
+
+    scan->section = section;
+    scan->is_empty = 1;
+    scan->section_start = scan->pool.count;
+}
+
+static void shallow_scan_add(struct shallow_scan *scan, const struct token *token) {
+    if (scan->is_empty) {
+        scan->is_empty = 0;
+        scan->start = token_position(token);
+    }
+
+    scan->end = token_position(token) + token_length(token);
+
+    if (token_is_of_type(T_PLACEHOLDER, token) && (scan->sections & (1u << scan->section))) {
+        tsqlp_placeholder_pool_reserve(&scan->pool, 1, scan->arena);
+
+        scan->pool.locations[scan->pool.count++] = token_position(token) - scan->start;
+    }
+}
+
+/*
+ * Section started by the clause keyword at the current token, outside of parentheses, or the current section if there
+ * is none. Keywords which are not part of the section they start are consumed and counted in skipped.
+ */
+static shallow_section
+shallow_scan_clause(struct lexer *lexer, const struct shallow_scan *scan, sql_token_type previous, int *skipped) {
+    shallow_section section = scan->section;
+    shallow_section next = section;
+    int keywords = 1;
+
+    switch (token_type(lexer_peek(lexer))) {
+        case T_K_INTO:
+            next = section < SHALLOW_TABLES ? SHALLOW_FIRST_INTO : SHALLOW_SECOND_INTO;
+            keywords = 0;
+            break;
+        case T_K_FROM:
+            next = SHALLOW_TABLES;
+            break;
+        case T_K_WHERE:
+            next = SHALLOW_WHERE;
+            break;
+        case T_K_GROUP:
+            // "FOR GROUP BY" belongs to an index hint
+            if (previous != T_K_FOR && token_is_of_type(T_K_BY, lexer_peek_next(lexer))) {
+                next = SHALLOW_GROUP_BY;
+                keywords = 2;
+            }
+            break;
+        case T_K_HAVING:
+            next = SHALLOW_HAVING;
+            break;
+        case T_K_ORDER:
+            if (previous != T_K_FOR && token_is_of_type(T_K_BY, lexer_peek_next(lexer))) {
+                next = SHALLOW_ORDER_BY;
+                keywords = 2;
+            }
+            break;
+        case T_K_LIMIT:
+            next = SHALLOW_LIMIT;
+            break;
+        case T_K_PROCEDURE:
+            next = SHALLOW_PROCEDURE;
+            break;
+        case T_K_FOR:
+            if (token_is_of_type(T_K_UPDATE, lexer_peek_next(lexer))) {
+                next = SHALLOW_FLAGS;
+                keywords = 0;
+            }
+            break;
+        case T_K_LOCK:
+            next = SHALLOW_FLAGS;
+            keywords = 0;
+            break;
+        default:
+            break;
+    }
+
+    // Clauses only come in order, a keyword which would go back is a part of the current section
+    if (next <= section) {
+        return section;
+    }
+
+    for (*skipped = 0; *skipped < keywords; (*skipped)++) {
+        lexer_consume(lexer);
+    }
+
+    return next;
+}
+
+static int is_modifier(const struct token *token) {
+    switch (token_type(token)) {
+        case T_K_ALL:
+            // intentional
+        case T_K_DISTINCT:
+            // intentional
+        case T_K_DISTINCTROW:
+            // intentional
+        case T_K_HIGH_PRIORITY:
+            // intentional
+        case T_K_STRAIGHT_JOIN:
+            // intentional
+        case T_K_SQL_SMALL_RESULT:
+            // intentional
+        case T_K_SQL_BIG_RESULT:
+            // intentional
+        case T_K_SQL_BUFFER_RESULT:
+            // intentional
+        case T_K_SQL_CACHE:
+            // intentional
+        case T_K_SQL_NO_CACHE:
+            // intentional
+        case T_K_SQL_CALC_FOUND_ROWS:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+tsqlp_parse_status tsqlp_shallow_scan(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
+                                      struct tsqlp_arena *arena, int use_views, unsigned int sections) {
+    const char *buff = lexer_buffer(lexer);
+    struct shallow_scan scan = {
+        .parse_result = parse_result,
+        .arena = arena,
+        .use_views = use_views,
+        .sections = sections,
+        .section = SHALLOW_MODIFIERS,
+        .is_empty = 1,
+        .start = 0,
+        .end = 0,
+        .pool = tsqlp_placeholder_pool_new(),
+        .section_start = 0
+    };
+
+    if (!token_is_of_type(T_K_SELECT, lexer_peek(lexer))) {
+        return TSQLP_PARSE_INVALID_SYNTAX;
+    }
+
+    lexer_consume(lexer);
+
+    while (is_modifier(lexer_peek(lexer))) {
+        struct token token = lexer_consume(lexer);
+
+        shallow_scan_add(&scan, &token);
+    }
+
+    shallow_scan_start_section(&scan, SHALLOW_COLUMNS, buff);
+
+    size_t depth = 0;
+    sql_token_type previous = T_K_SELECT;
+
+    while (lexer_has(lexer)) {
+        if (depth == 0) {
+            int skipped = 0;
+            shallow_section section = shallow_scan_clause(lexer, &scan, previous, &skipped);
+
+            if (section != scan.section) {
+                shallow_scan_start_section(&scan, section, buff);
+
+                // A statement can not end right after a clause keyword
+                if (skipped > 0 && !lexer_has(lexer)) {
+                    return TSQLP_PARSE_INVALID_SYNTAX;
+                }
+
+                continue;
+            }
+        }
+
+        // The lexer stops at a token it does not know, it is returned over and over
+        if (token_is_of_type(T_UNKNOWN, lexer_peek(lexer))) {
+            return TSQLP_PARSE_INVALID_SYNTAX;
+        }
+
+        struct token token = lexer_consume(lexer);
+
+        if (token_is_of_type(T_OPEN_PAREN, &token)) {
+            depth++;
+        } else if (token_is_of_type(T_CLOSE_PAREN, &token)) {
+            if (depth == 0) {
+                return TSQLP_PARSE_INVALID_SYNTAX;
+            }
+
+            depth--;
+        }
+
+        previous = token_type(&token);
+        shallow_scan_add(&scan, &token);
+    }
+
+    if (depth > 0) {
+        return TSQLP_PARSE_INVALID_SYNTAX;
+    }
+
+    shallow_scan_finish_section(&scan, buff);
+
+    return TSQLP_PARSE_OK;
+}
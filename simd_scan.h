@@ -0,0 +1,239 @@
+#ifndef SQL_QUERY_PARSER_SIMD_SCAN_H
+#define SQL_QUERY_PARSER_SIMD_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Vectorized searches used by the table scanner on long runs of bytes. AVX2 is used when the compiler targets it
+ * (for example with -DTSQLP_NATIVE=ON on a capable CPU), otherwise SSE2 which every x86-64 CPU has. Other targets
+ * use the scalar loops which are also used for the tail shorter than one vector.
+ */
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_SCAN_WIDTH 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SIMD_SCAN_WIDTH 16
+#endif
+
+#define SIMD_SCAN_IS_SPACE(c) ((c) == ' ' || (unsigned char) ((c) - '\t') <= '\r' - '\t')
+#define SIMD_SCAN_IS_HEX_DIGIT(c) ((unsigned char) ((c) - '0') <= 9 || (unsigned char) (((c) | 0x20) - 'a') <= 5)
+
+#if defined(__AVX2__)
+
+static inline uint32_t simd_scan_either_mask(const char *buff, char first, char second) {
+    __m256i chunk = _mm256_loadu_si256((const __m256i *) buff);
+
+    return (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(
+        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(first)),
+        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(second))
+    ));
+}
+
+static inline uint32_t simd_scan_non_space_mask(const char *buff) {
+    __m256i chunk = _mm256_loadu_si256((const __m256i *) buff);
+    __m256i shifted = _mm256_sub_epi8(chunk, _mm256_set1_epi8('\t'));
+    __m256i space = _mm256_or_si256(
+        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+        _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted)
+    );
+
+    return ~(uint32_t) _mm256_movemask_epi8(space);
+}
+
+static inline uint32_t simd_scan_non_ascii_mask(const char *buff) {
+    return (uint32_t) _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *) buff));
+}
+
+static inline uint32_t simd_scan_non_hex_digit_mask(const char *buff) {
+    __m256i chunk = _mm256_loadu_si256((const __m256i *) buff);
+    __m256i digit = _mm256_sub_epi8(chunk, _mm256_set1_epi8('0'));
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chunk, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i hex_digit = _mm256_or_si256(
+        _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit),
+        _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter)
+    );
+
+    return ~(uint32_t) _mm256_movemask_epi8(hex_digit);
+}
+
+#elif defined(__SSE2__)
+
+static inline uint32_t simd_scan_either_mask(const char *buff, char first, char second) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *) buff);
+
+    return (uint32_t) _mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(chunk, _mm_set1_epi8(first)),
+        _mm_cmpeq_epi8(chunk, _mm_set1_epi8(second))
+    ));
+}
+
+static inline uint32_t simd_scan_non_space_mask(const char *buff) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *) buff);
+    __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8('\t'));
+    __m128i space = _mm_or_si128(
+        _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+        _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted)
+    );
+
+    return ~(uint32_t) _mm_movemask_epi8(space) & 0xffffu;
+}
+
+static inline uint32_t simd_scan_non_ascii_mask(const char *buff) {
+    return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) buff));
+}
+
+static inline uint32_t simd_scan_non_hex_digit_mask(const char *buff) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *) buff);
+    __m128i digit = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(chunk, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i hex_digit = _mm_or_si128(
+        _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit),
+        _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter)
+    );
+
+    return ~(uint32_t) _mm_movemask_epi8(hex_digit) & 0xffffu;
+}
+
+#endif
+
+/*
+ * Sets bit i of masks[n] when block[i] == needles[n], for a block of 64 bytes. Each part of the block is loaded once
+ * and compared against every needle.
+ */
+static inline void simd_scan_classify64(const char *block, const char *needles, int count, uint64_t *masks) {
+#if defined(__AVX2__)
+    __m256i low = _mm256_loadu_si256((const __m256i *) block);
+    __m256i high = _mm256_loadu_si256((const __m256i *) (block + 32));
+
+    for (int n = 0; n < count; n++) {
+        __m256i needle = _mm256_set1_epi8(needles[n]);
+
+        masks[n] = (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(low, needle))
+                   | (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(high, needle)) << 32;
+    }
+#elif defined(__SSE2__)
+    __m128i first = _mm_loadu_si128((const __m128i *) block);
+    __m128i second = _mm_loadu_si128((const __m128i *) (block + 16));
+    __m128i third = _mm_loadu_si128((const __m128i *) (block + 32));
+    __m128i fourth = _mm_loadu_si128((const __m128i *) (block + 48));
+
+    for (int n = 0; n < count; n++) {
+        __m128i needle = _mm_set1_epi8(needles[n]);
+
+        masks[n] = (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(first, needle))
+                   | (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(second, needle)) << 16
+                   | (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(third, needle)) << 32
+                   | (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(fourth, needle)) << 48;
+    }
+#else
+    for (int n = 0; n < count; n++) {
+        masks[n] = 0;
+
+        for (int i = 0; i < 64; i++) {
+            masks[n] |= (uint64_t) (block[i] == needles[n]) << i;
+        }
+    }
+#endif
+}
+
+/*
+ * Returns offset of the first byte equal to first or second at or after offset, or len if there is none
+ */
+static inline size_t simd_scan_find_either(const char *buff, size_t offset, size_t len, char first, char second) {
+#ifdef SIMD_SCAN_WIDTH
+    for (; offset + SIMD_SCAN_WIDTH <= len; offset += SIMD_SCAN_WIDTH) {
+        uint32_t mask = simd_scan_either_mask(buff + offset, first, second);
+
+        if (mask != 0) {
+            return offset + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; offset < len; offset++) {
+        if (buff[offset] == first || buff[offset] == second) {
+            return offset;
+        }
+    }
+
+    return len;
+}
+
+/*
+ * Returns offset of the first byte not in [[:space:]] at or after offset, or len if there is none
+ */
+static inline size_t simd_scan_skip_spaces(const char *buff, size_t offset, size_t len) {
+    // Most runs are a single space, so look at the next byte before going wide
+    if (offset >= len || !SIMD_SCAN_IS_SPACE(buff[offset])) {
+        return offset;
+    }
+
+#ifdef SIMD_SCAN_WIDTH
+    for (; offset + SIMD_SCAN_WIDTH <= len; offset += SIMD_SCAN_WIDTH) {
+        uint32_t mask = simd_scan_non_space_mask(buff + offset);
+
+        if (mask != 0) {
+            return offset + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; offset < len; offset++) {
+        if (!SIMD_SCAN_IS_SPACE(buff[offset])) {
+            return offset;
+        }
+    }
+
+    return len;
+}
+
+/*
+ * Returns offset of the first byte not in [a-fA-F0-9] at or after offset, or len if there is none
+ */
+static inline size_t simd_scan_skip_hex_digits(const char *buff, size_t offset, size_t len) {
+#ifdef SIMD_SCAN_WIDTH
+    for (; offset + SIMD_SCAN_WIDTH <= len; offset += SIMD_SCAN_WIDTH) {
+        uint32_t mask = simd_scan_non_hex_digit_mask(buff + offset);
+
+        if (mask != 0) {
+            return offset + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; offset < len; offset++) {
+        if (!SIMD_SCAN_IS_HEX_DIGIT(buff[offset])) {
+            return offset;
+        }
+    }
+
+    return len;
+}
+
+/*
+ * Returns offset of the first byte outside of ASCII at or after offset, or len if there is none
+ */
+static inline size_t simd_scan_skip_ascii(const char *buff, size_t offset, size_t len) {
+#ifdef SIMD_SCAN_WIDTH
+    for (; offset + SIMD_SCAN_WIDTH <= len; offset += SIMD_SCAN_WIDTH) {
+        uint32_t mask = simd_scan_non_ascii_mask(buff + offset);
+
+        if (mask != 0) {
+            return offset + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; offset < len; offset++) {
+        if ((unsigned char) buff[offset] >= 0x80) {
+            return offset;
+        }
+    }
+
+    return len;
+}
+
+#endif //SQL_QUERY_PARSER_SIMD_SCAN_H
@@ -0,0 +1,240 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "structural_index.h"
+#include "comment_scan.h"
+#include "simd_scan.h"
+
+/*
+ * The index is built in two stages, in the spirit of simdjson.
+ *
+ * Stage one classifies 64 bytes at a time into bitmaps of quotes, backticks, backslashes, comment starts and
+ * structural characters. Stage two walks only the set bits of the first ones to find where literals and comments
+ * open and close, following the scanner rules: strings are closed by the same quote that opened them and may contain
+ * backslash escapes, backtick identifiers are closed by the next backtick and comments are matched by
+ * comment_scan_match(). Structural characters inside literals and comments are then masked out word by word.
+ */
+
+#define BLOCK_SIZE 64
+#define BITMAP_COUNT 7
+#define NEEDLE_COUNT 11
+#define SPECIAL_COUNT 7
+
+// Quote characters, backslash and comment starts first, then the structural characters in the order of their bitmaps
+static const char needles[NEEDLE_COUNT] = {'\'', '"', '`', '\\', '#', '-', '/', '(', ')', ',', '?'};
+
+static void set_range(uint64_t *bitmap, size_t from, size_t to) {
+    size_t first_word = from / 64;
+    size_t last_word = to / 64;
+    uint64_t first_mask = ~(uint64_t) 0 << (from % 64);
+    uint64_t last_mask = ~(uint64_t) 0 >> (63 - to % 64);
+
+    if (first_word == last_word) {
+        bitmap[first_word] |= first_mask & last_mask;
+
+        return;
+    }
+
+    bitmap[first_word] |= first_mask;
+
+    for (size_t word = first_word + 1; word < last_word; word++) {
+        bitmap[word] = ~(uint64_t) 0;
+    }
+
+    bitmap[last_word] |= last_mask;
+}
+
+/*
+ * Marks string, backtick and comment regions. Unterminated literals run to the end of the input, where the scanner
+ * would stop with an unknown token anyway.
+ */
+static void mark_literals(struct structural_index *structural_index, const uint64_t *specials, const char *buff, size_t len) {
+    char quote = 0;
+    size_t region_start = 0;
+    // Bits before this offset are escaped or inside of a comment
+    size_t resume = 0;
+
+    for (size_t word = 0; word < structural_index->words; word++) {
+        for (uint64_t bits = specials[word]; bits != 0; bits &= bits - 1) {
+            size_t offset = word * 64 + __builtin_ctzll(bits);
+            char c = buff[offset];
+
+            if (offset < resume) {
+                continue;
+            }
+
+            if (quote == 0 && (c == '#' || c == '-' || c == '/')) {
+                sql_token_type type;
+                size_t comment_len = comment_scan_match(buff, offset, len, &type);
+
+                if (comment_len > 0) {
+                    set_range(structural_index->comments, offset, offset + comment_len - 1);
+                    resume = offset + comment_len;
+                }
+
+                continue;
+            }
+
+            if (quote == 0) {
+                if (c != '\\') {
+                    quote = c;
+                    region_start = offset;
+                }
+
+                continue;
+            }
+
+            if (c == '\\') {
+                if (quote != '`') {
+                    resume = offset + 2;
+                }
+
+                continue;
+            }
+
+            if (c != quote) {
+                continue;
+            }
+
+            set_range(quote == '`' ? structural_index->backticks : structural_index->strings, region_start, offset);
+            quote = 0;
+        }
+    }
+
+    if (quote != 0) {
+        set_range(quote == '`' ? structural_index->backticks : structural_index->strings, region_start, len - 1);
+    }
+}
+
+struct structural_index structural_index_new(const char *buff, size_t len) {
+    struct structural_index structural_index = {
+        .strings = NULL,
+        .backticks = NULL,
+        .comments = NULL,
+        .open_parens = NULL,
+        .close_parens = NULL,
+        .commas = NULL,
+        .placeholders = NULL,
+        .words = 0,
+        .capacity = 0
+    };
+
+    structural_index_rebuild(&structural_index, buff, len);
+
+    return structural_index;
+}
+
+void structural_index_rebuild(struct structural_index *structural_index, const char *buff, size_t len) {
+    size_t words = len / 64 + 1;
+    uint64_t *bitmaps = structural_index->strings;
+
+    if (words > structural_index->capacity) {
+        free(bitmaps);
+        bitmaps = malloc(words * (BITMAP_COUNT + 1) * sizeof(uint64_t));
+
+        if (bitmaps == NULL) {
+            exit(2);
+        }
+
+        structural_index->capacity = words;
+    }
+
+    memset(bitmaps, 0, words * (BITMAP_COUNT + 1) * sizeof(uint64_t));
+
+    structural_index->strings = bitmaps;
+    structural_index->backticks = bitmaps + words;
+    structural_index->comments = bitmaps + 2 * words;
+    structural_index->open_parens = bitmaps + 3 * words;
+    structural_index->close_parens = bitmaps + 4 * words;
+    structural_index->commas = bitmaps + 5 * words;
+    structural_index->placeholders = bitmaps + 6 * words;
+    structural_index->words = words;
+
+    // Quotes, backticks, backslashes and comment starts for the second stage, freed together with the rest
+    uint64_t *specials = bitmaps + BITMAP_COUNT * words;
+    uint64_t masks[NEEDLE_COUNT];
+    char tail[BLOCK_SIZE];
+
+    for (size_t offset = 0; offset < len; offset += BLOCK_SIZE) {
+        const char *block = buff + offset;
+        size_t word = offset / 64;
+
+        if (len - offset < BLOCK_SIZE) {
+            memset(tail, 0, BLOCK_SIZE);
+            memcpy(tail, block, len - offset);
+            block = tail;
+        }
+
+        simd_scan_classify64(block, needles, NEEDLE_COUNT, masks);
+
+        specials[word] = masks[0];
+
+        for (int n = 1; n < SPECIAL_COUNT; n++) {
+            specials[word] |= masks[n];
+        }
+
+        structural_index->open_parens[word] = masks[SPECIAL_COUNT];
+        structural_index->close_parens[word] = masks[SPECIAL_COUNT + 1];
+        structural_index->commas[word] = masks[SPECIAL_COUNT + 2];
+        structural_index->placeholders[word] = masks[SPECIAL_COUNT + 3];
+    }
+
+    mark_literals(structural_index, specials, buff, len);
+
+    for (size_t word = 0; word < words; word++) {
+        uint64_t outside = ~(structural_index->strings[word] | structural_index->backticks[word] | structural_index->comments[word]);
+
+        structural_index->open_parens[word] &= outside;
+        structural_index->close_parens[word] &= outside;
+        structural_index->commas[word] &= outside;
+        structural_index->placeholders[word] &= outside;
+    }
+}
+
+void structural_index_destroy(struct structural_index *structural_index) {
+    free(structural_index->strings);
+}
+
+size_t structural_index_count(const uint64_t *bitmap, size_t from, size_t to) {
+    if (from >= to) {
+        return 0;
+    }
+
+    size_t first_word = from / 64;
+    size_t last_word = (to - 1) / 64;
+    uint64_t first_mask = ~(uint64_t) 0 << (from % 64);
+    uint64_t last_mask = ~(uint64_t) 0 >> (63 - (to - 1) % 64);
+
+    if (first_word == last_word) {
+        return __builtin_popcountll(bitmap[first_word] & first_mask & last_mask);
+    }
+
+    size_t count = __builtin_popcountll(bitmap[first_word] & first_mask);
+
+    for (size_t word = first_word + 1; word < last_word; word++) {
+        count += __builtin_popcountll(bitmap[word]);
+    }
+
+    return count + __builtin_popcountll(bitmap[last_word] & last_mask);
+}
+
+size_t structural_index_next(const uint64_t *bitmap, size_t from, size_t to) {
+    if (from >= to) {
+        return to;
+    }
+
+    size_t word = from / 64;
+    uint64_t bits = bitmap[word] & (~(uint64_t) 0 << (from % 64));
+
+    while (bits == 0) {
+        if (++word * 64 >= to) {
+            return to;
+        }
+
+        bits = bitmap[word];
+    }
+
+    size_t offset = word * 64 + __builtin_ctzll(bits);
+
+    return offset < to ? offset : to;
+}
@@ -0,0 +1,44 @@
+#ifndef SQL_QUERY_PARSER_STRUCTURAL_INDEX_H
+#define SQL_QUERY_PARSER_STRUCTURAL_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Bitmaps over the SQL text where bit i of a bitmap describes byte i. Literal bitmaps cover string, backtick and
+ * comment regions including their delimiters, while the structural ones only mark bytes outside of those regions,
+ * which are exactly the bytes the scanner returns as single character tokens.
+ */
+struct structural_index {
+    uint64_t *strings;
+    uint64_t *backticks;
+    uint64_t *comments;
+    uint64_t *open_parens;
+    uint64_t *close_parens;
+    uint64_t *commas;
+    uint64_t *placeholders;
+    size_t words;
+    // Words allocated for each bitmap, which can be more than words after a rebuild
+    size_t capacity;
+};
+
+struct structural_index structural_index_new(const char *buff, size_t len);
+
+/*
+ * Indexes another query, reusing the bitmaps when they are large enough
+ */
+void structural_index_rebuild(struct structural_index *structural_index, const char *buff, size_t len);
+
+void structural_index_destroy(struct structural_index *structural_index);
+
+/*
+ * Number of bits set in [from, to)
+ */
+size_t structural_index_count(const uint64_t *bitmap, size_t from, size_t to);
+
+/*
+ * Offset of the first bit set in [from, to), or to if there is none
+ */
+size_t structural_index_next(const uint64_t *bitmap, size_t from, size_t to);
+
+#endif //SQL_QUERY_PARSER_STRUCTURAL_INDEX_H
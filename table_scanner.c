@@ -0,0 +1,560 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lexer.h"
+#include "keywords.h"
+#include "comment_scan.h"
+#include "simd_scan.h"
+
+/*
+ * Hand-written alternative to the flex scanner generated from lexer.l.
+ *
+ * Every byte is mapped through a 256-entry class table and the first byte of a lexeme selects which rules can
+ * apply. Rules are matched the way flex does it: the longest match wins and on equal length the rule that comes
+ * first in lexer.l wins, so the produced token stream is the same as the one produced by the flex scanner.
+ *
+ * Keywords and interval units are lexed as identifiers and then looked up in the perfect hash table generated into
+ * keywords.h by keywords_generator.
+ *
+ * Comments are not rules of lexer.l, both scanners match them with comment_scan.h.
+ */
+
+typedef enum {
+    CLASS_OTHER = 0,
+    CLASS_SPACE,
+    CLASS_DIGIT,
+    CLASS_LETTER,
+    CLASS_IDENTIFIER_SYMBOL,
+    CLASS_BACKTICK,
+    CLASS_QUOTE,
+    CLASS_DOT,
+    CLASS_AT,
+    CLASS_OPERATOR,
+    CLASS_PUNCTUATION,
+    CLASS_COMMENT
+} char_class;
+
+static const unsigned char char_classes[256] = {
+    ['\t'] = CLASS_SPACE,
+    ['\n'] = CLASS_SPACE,
+    ['\v'] = CLASS_SPACE,
+    ['\f'] = CLASS_SPACE,
+    ['\r'] = CLASS_SPACE,
+    [' '] = CLASS_SPACE,
+    ['0' ... '9'] = CLASS_DIGIT,
+    ['a' ... 'z'] = CLASS_LETTER,
+    ['A' ... 'Z'] = CLASS_LETTER,
+    ['_'] = CLASS_IDENTIFIER_SYMBOL,
+    ['$'] = CLASS_IDENTIFIER_SYMBOL,
+    // Bytes of multibyte UTF-8 characters, the input is validated before it is scanned
+    [0x80 ... 0xff] = CLASS_IDENTIFIER_SYMBOL,
+    ['`'] = CLASS_BACKTICK,
+    ['\''] = CLASS_QUOTE,
+    ['"'] = CLASS_QUOTE,
+    ['.'] = CLASS_DOT,
+    ['@'] = CLASS_AT,
+    ['<'] = CLASS_OPERATOR,
+    ['>'] = CLASS_OPERATOR,
+    ['='] = CLASS_OPERATOR,
+    ['!'] = CLASS_OPERATOR,
+    ['&'] = CLASS_OPERATOR,
+    ['|'] = CLASS_OPERATOR,
+    [','] = CLASS_PUNCTUATION,
+    ['('] = CLASS_PUNCTUATION,
+    [')'] = CLASS_PUNCTUATION,
+    ['?'] = CLASS_PUNCTUATION,
+    ['+'] = CLASS_PUNCTUATION,
+    ['-'] = CLASS_PUNCTUATION,
+    ['*'] = CLASS_PUNCTUATION,
+    ['/'] = CLASS_PUNCTUATION,
+    ['%'] = CLASS_PUNCTUATION,
+    ['^'] = CLASS_PUNCTUATION,
+    ['~'] = CLASS_PUNCTUATION,
+    ['#'] = CLASS_COMMENT,
+};
+
+struct table_scanner {
+    const char *buff;
+    size_t len;
+    size_t position;
+};
+
+#define CLASS_AT(scanner, offset) \
+    ((offset) < (scanner)->len ? char_classes[(unsigned char) (scanner)->buff[offset]] : CLASS_OTHER)
+#define CHAR_AT(scanner, offset) ((offset) < (scanner)->len ? (scanner)->buff[offset] : '\0')
+
+#define CLASS_SET(class) (1u << (class))
+#define DIGIT_CLASSES CLASS_SET(CLASS_DIGIT)
+#define ALNUM_CLASSES (CLASS_SET(CLASS_DIGIT) | CLASS_SET(CLASS_LETTER))
+#define IDENTIFIER_CLASSES (ALNUM_CLASSES | CLASS_SET(CLASS_IDENTIFIER_SYMBOL))
+
+static size_t skip_class_run(const struct table_scanner *scanner, size_t offset, unsigned int classes) {
+    while (offset < scanner->len && (CLASS_SET(char_classes[(unsigned char) scanner->buff[offset]]) & classes)) {
+        offset++;
+    }
+
+    return offset;
+}
+
+/*
+ * [a-z_$][a-z_$0-9]*|`[^`]+`
+ */
+static size_t match_identifier(const struct table_scanner *scanner, size_t start) {
+    char_class class = CLASS_AT(scanner, start);
+
+    if (class == CLASS_LETTER || class == CLASS_IDENTIFIER_SYMBOL) {
+        return skip_class_run(scanner, start + 1, IDENTIFIER_CLASSES) - start;
+    }
+
+    if (class != CLASS_BACKTICK) {
+        return 0;
+    }
+
+    size_t end = simd_scan_find_either(scanner->buff, start + 1, scanner->len, '`', '`');
+
+    if (end == scanner->len || end == start + 1) {
+        return 0;
+    }
+
+    return end - start + 1;
+}
+
+/*
+ * One quoted part of [[:alnum:]]*'(\\.|[^'\\]+)*' starting at the opening quote. Returns offset after the closing
+ * quote or 0 when the part can not be closed.
+ */
+static size_t match_quoted_part(const struct table_scanner *scanner, size_t offset, char quote) {
+    for (offset++; ; offset += 2) {
+        offset = simd_scan_find_either(scanner->buff, offset, scanner->len, quote, '\\');
+
+        if (offset == scanner->len) {
+            return 0;
+        }
+
+        if (scanner->buff[offset] == quote) {
+            return offset + 1;
+        }
+
+        if (offset + 1 == scanner->len || scanner->buff[offset + 1] == '\n') {
+            return 0;
+        }
+    }
+}
+
+/*
+ * [[:alnum:]]*'(\\.|[^'\\]+)*'([[:space:]]*[[:alnum:]]*'(\\.|[^'\\]+)*')* and the same with double quotes
+ */
+static size_t match_string(const struct table_scanner *scanner, size_t start) {
+    size_t offset = skip_class_run(scanner, start, ALNUM_CLASSES);
+    char quote = CHAR_AT(scanner, offset);
+
+    if (quote != '\'' && quote != '"') {
+        return 0;
+    }
+
+    size_t matched = 0;
+
+    while (1) {
+        offset = match_quoted_part(scanner, offset, quote);
+
+        if (offset == 0) {
+            return matched;
+        }
+
+        matched = offset - start;
+
+        offset = simd_scan_skip_spaces(scanner->buff, offset, scanner->len);
+        offset = skip_class_run(scanner, offset, ALNUM_CLASSES);
+
+        if (CHAR_AT(scanner, offset) != quote) {
+            return matched;
+        }
+    }
+}
+
+/*
+ * b'[01]+'
+ */
+static size_t match_bit_value(const struct table_scanner *scanner, size_t start) {
+    if ((CHAR_AT(scanner, start) | 0x20) != 'b' || CHAR_AT(scanner, start + 1) != '\'') {
+        return 0;
+    }
+
+    size_t offset = start + 2;
+
+    while (CHAR_AT(scanner, offset) == '0' || CHAR_AT(scanner, offset) == '1') {
+        offset++;
+    }
+
+    if (offset == start + 2 || CHAR_AT(scanner, offset) != '\'') {
+        return 0;
+    }
+
+    return offset + 1 - start;
+}
+
+/*
+ * 0x[a-fA-F0-9]+|x'[a-fA-F0-9]+'
+ */
+static size_t match_hex_value(const struct table_scanner *scanner, size_t start) {
+    size_t offset;
+
+    if (CHAR_AT(scanner, start) == '0' && (CHAR_AT(scanner, start + 1) | 0x20) == 'x') {
+        offset = start + 2;
+    } else if ((CHAR_AT(scanner, start) | 0x20) == 'x' && CHAR_AT(scanner, start + 1) == '\'') {
+        offset = start + 2;
+    } else {
+        return 0;
+    }
+
+    offset = simd_scan_skip_hex_digits(scanner->buff, offset, scanner->len);
+
+    if (offset == start + 2) {
+        return 0;
+    }
+
+    if (CHAR_AT(scanner, start) == '0') {
+        return offset - start;
+    }
+
+    return CHAR_AT(scanner, offset) == '\'' ? offset + 1 - start : 0;
+}
+
+/*
+ * ([[:digit:]]+("."[[:digit:]]*)?|"."[[:digit:]]+)([eE][+-]?[[:digit:]]+)?
+ */
+static size_t match_number(const struct table_scanner *scanner, size_t start) {
+    size_t offset = start;
+
+    if (CLASS_AT(scanner, offset) == CLASS_DIGIT) {
+        offset = skip_class_run(scanner, offset, DIGIT_CLASSES);
+
+        if (CHAR_AT(scanner, offset) == '.') {
+            offset = skip_class_run(scanner, offset + 1, DIGIT_CLASSES);
+        }
+    } else if (CHAR_AT(scanner, offset) == '.' && CLASS_AT(scanner, offset + 1) == CLASS_DIGIT) {
+        offset = skip_class_run(scanner, offset + 1, DIGIT_CLASSES);
+    } else {
+        return 0;
+    }
+
+    if ((CHAR_AT(scanner, offset) | 0x20) == 'e') {
+        size_t exponent = offset + 1;
+
+        if (CHAR_AT(scanner, exponent) == '+' || CHAR_AT(scanner, exponent) == '-') {
+            exponent++;
+        }
+
+        if (CLASS_AT(scanner, exponent) == CLASS_DIGIT) {
+            offset = skip_class_run(scanner, exponent, DIGIT_CLASSES);
+        }
+    }
+
+    return offset - start;
+}
+
+/*
+ * Identifier followed by one or two "."-separated identifiers, or by ".*" / ".identifier.*"
+ */
+static size_t match_identifier_chain(const struct table_scanner *scanner, size_t start, size_t len, sql_token_type *type) {
+    *type = T_IDENTIFIER;
+
+    for (int parts = 1; parts < 3 && CHAR_AT(scanner, start + len) == '.'; parts++) {
+        if (CHAR_AT(scanner, start + len + 1) == '*') {
+            *type = T_WILDCARD_IDENTIFIER;
+
+            return len + 2;
+        }
+
+        size_t part = match_identifier(scanner, start + len + 1);
+
+        if (part == 0) {
+            break;
+        }
+
+        len += 1 + part;
+        *type = T_QUALIFIED_IDENTIFIER;
+    }
+
+    return len;
+}
+
+static size_t lex_word(const struct table_scanner *scanner, size_t start, sql_token_type *type) {
+    size_t word_len = match_identifier(scanner, start);
+    size_t len = match_identifier_chain(scanner, start, word_len, type);
+
+    if (*type == T_IDENTIFIER && CLASS_AT(scanner, start) != CLASS_BACKTICK) {
+        *type = keyword_type(scanner->buff + start, word_len);
+    }
+
+    if (CLASS_AT(scanner, start) != CLASS_LETTER) {
+        return len;
+    }
+
+    size_t string_len = match_string(scanner, start);
+
+    if (string_len > len) {
+        *type = T_STRING;
+        len = string_len;
+    }
+
+    // Bit and hex values come before strings in lexer.l so they win when the lengths are equal
+    size_t value_len = match_bit_value(scanner, start);
+
+    if (value_len > 0 && value_len >= len) {
+        *type = T_BIT_VALUE;
+        len = value_len;
+    }
+
+    value_len = match_hex_value(scanner, start);
+
+    if (value_len > 0 && value_len >= len) {
+        *type = T_HEX_VALUE;
+        len = value_len;
+    }
+
+    return len;
+}
+
+static size_t lex_digit(const struct table_scanner *scanner, size_t start, sql_token_type *type) {
+    size_t len = match_number(scanner, start);
+    size_t other_len = match_hex_value(scanner, start);
+
+    *type = T_NUMBER;
+
+    if (other_len > len) {
+        *type = T_HEX_VALUE;
+        len = other_len;
+    }
+
+    other_len = match_string(scanner, start);
+
+    if (other_len > len) {
+        *type = T_STRING;
+        len = other_len;
+    }
+
+    return len;
+}
+
+static size_t lex_operator(const struct table_scanner *scanner, size_t start, sql_token_type *type) {
+    char next = CHAR_AT(scanner, start + 1);
+
+    switch (scanner->buff[start]) {
+        case '<':
+            if (next == '=' && CHAR_AT(scanner, start + 2) == '>') {
+                *type = T_ARROW;
+
+                return 3;
+            }
+
+            if (next == '<') {
+                *type = T_LEFT_SHIFT;
+
+                return 2;
+            }
+
+            *type = T_COMPARISON_OPERATOR;
+
+            return next == '=' || next == '>' ? 2 : 1;
+        case '>':
+            if (next == '>') {
+                *type = T_RIGHT_SHIFT;
+
+                return 2;
+            }
+
+            *type = T_COMPARISON_OPERATOR;
+
+            return next == '=' ? 2 : 1;
+        case '!':
+            *type = next == '=' ? T_COMPARISON_OPERATOR : T_NOT;
+
+            return next == '=' ? 2 : 1;
+        case '&':
+            *type = next == '&' ? T_AND : T_BIT_AND;
+
+            return next == '&' ? 2 : 1;
+        case '|':
+            *type = next == '|' ? T_OR : T_BIT_OR;
+
+            return next == '|' ? 2 : 1;
+        default:
+            *type = T_COMPARISON_OPERATOR;
+
+            return 1;
+    }
+}
+
+static sql_token_type punctuation_type(char c) {
+    switch (c) {
+        case ',':
+            return T_COMMA;
+        case '(':
+            return T_OPEN_PAREN;
+        case ')':
+            return T_CLOSE_PAREN;
+        case '?':
+            return T_PLACEHOLDER;
+        case '+':
+            return T_PLUS;
+        case '-':
+            return T_MINUS;
+        case '*':
+            return T_MULT;
+        case '/':
+            return T_DIV;
+        case '%':
+            return T_MOD;
+        case '^':
+            return T_BIT_XOR;
+        default:
+            return T_BIT_NOT;
+    }
+}
+
+/*
+ * @@?([a-z_$][a-z_$0-9]*|`[^`]+`)
+ */
+static size_t match_variable(const struct table_scanner *scanner, size_t start) {
+    size_t offset = start + 1;
+
+    if (CHAR_AT(scanner, offset) == '@') {
+        offset++;
+    }
+
+    size_t len = match_identifier(scanner, offset);
+
+    return len == 0 ? 0 : offset + len - start;
+}
+
+static size_t lex_token(const struct table_scanner *scanner, size_t start, sql_token_type *type) {
+    size_t len = 0;
+
+    switch ((char_class) char_classes[(unsigned char) scanner->buff[start]]) {
+        case CLASS_SPACE:
+            *type = T_WHITE_SPACE;
+
+            return simd_scan_skip_spaces(scanner->buff, start + 1, scanner->len) - start;
+        case CLASS_LETTER:
+            // intentional
+        case CLASS_IDENTIFIER_SYMBOL:
+            return lex_word(scanner, start, type);
+        case CLASS_BACKTICK:
+            if (match_identifier(scanner, start) > 0) {
+                return lex_word(scanner, start, type);
+            }
+
+            break;
+        case CLASS_DIGIT:
+            return lex_digit(scanner, start, type);
+        case CLASS_QUOTE:
+            *type = T_STRING;
+            len = match_string(scanner, start);
+
+            break;
+        case CLASS_DOT:
+            *type = T_NUMBER;
+            len = match_number(scanner, start);
+
+            break;
+        case CLASS_AT:
+            *type = T_VARIABLE;
+            len = match_variable(scanner, start);
+
+            break;
+        case CLASS_OPERATOR:
+            return lex_operator(scanner, start, type);
+        case CLASS_PUNCTUATION:
+            // "-" and "/" may start a comment
+            len = comment_scan_match(scanner->buff, start, scanner->len, type);
+
+            if (len > 0) {
+                return len;
+            }
+
+            *type = punctuation_type(scanner->buff[start]);
+
+            return 1;
+        case CLASS_COMMENT:
+            return comment_scan_match(scanner->buff, start, scanner->len, type);
+        default:
+            break;
+    }
+
+    if (len == 0) {
+        *type = T_UNKNOWN;
+        len = 1;
+    }
+
+    return len;
+}
+
+void *lexer_use_buffer(const char *buff, size_t len) {
+    struct table_scanner *scanner = (struct table_scanner *) malloc(sizeof(struct table_scanner));
+
+    if (scanner == NULL) {
+        exit(2);
+    }
+
+    *scanner = (struct table_scanner) {
+        .buff = buff,
+        .len = len,
+        .position = 0
+    };
+
+    return scanner;
+}
+
+void *lexer_reuse_buffer(void *scanner, const char *buff, size_t len) {
+    if (scanner == NULL) {
+        return lexer_use_buffer(buff, len);
+    }
+
+    *(struct table_scanner *) scanner = (struct table_scanner) {
+        .buff = buff,
+        .len = len,
+        .position = 0
+    };
+
+    return scanner;
+}
+
+/*
+ * Sets the scanner up in memory of the caller, which must not be passed to lexer_clear_buffer(). Returns NULL when it
+ * does not fit.
+ */
+void *lexer_place_buffer(void *memory, size_t size, const char *buff, size_t len) {
+    if (size < sizeof(struct table_scanner)) {
+        return NULL;
+    }
+
+    *(struct table_scanner *) memory = (struct table_scanner) {
+        .buff = buff,
+        .len = len,
+        .position = 0
+    };
+
+    return memory;
+}
+
+void lexer_clear_buffer(void *scanner) {
+    free(scanner);
+}
+
+struct token lexer_lex(void *handle) {
+    struct table_scanner *scanner = (struct table_scanner *) handle;
+    size_t start = scanner->position;
+
+    if (start >= scanner->len) {
+        return token_new(T_EOF, NULL, 0, scanner->len);
+    }
+
+    sql_token_type type = T_UNKNOWN;
+    size_t len = lex_token(scanner, start, &type);
+
+    scanner->position += len;
+
+    return token_new(type, scanner->buff + start, len, start);
+}
@@ -1,8 +1,17 @@
 #include <criterion/criterion.h>
+#include <stdio.h>
 #include <string.h>
+#include <strings.h>
+#include <ctype.h>
 #include <stdarg.h>
+#include <pthread.h>
 
 #include "tsqlp.h"
+#include "structural_index.h"
+
+#ifdef TSQLP_TABLE_SCANNER
+#include "keywords.h"
+#endif
 
 typedef enum {
     SECTION_MODIFIERS = 1,
@@ -74,7 +83,21 @@ struct tsqlp_parse_result *make_parse_result(sql_section_type section_name, stru
     return parse_result;
 }
 
+/*
+ * Expected sections are built before the parse result they go to, so they live in an arena of their own
+ */
+static struct tsqlp_arena *expected_sections_arena() {
+    static struct tsqlp_parse_result *owner = NULL;
+
+    if (owner == NULL) {
+        owner = tsqlp_parse_result_new();
+    }
+
+    return tsqlp_parse_result_arena(owner);
+}
+
 static struct tsqlp_sql_section sql_section_new_from_string(char *chunk, size_t placeholder_count, ...) {
+    struct tsqlp_arena *arena = expected_sections_arena();
     struct tsqlp_sql_section section = tsqlp_sql_section_new();
 
     struct tsqlp_placeholders placeholders = tsqlp_placeholders_new();
@@ -84,11 +107,11 @@ static struct tsqlp_sql_section sql_section_new_from_string(char *chunk, size_t
     for (int i = 0; i < placeholder_count; i++) {
         size_t location = va_arg(arg_pointer, size_t);
 
-        tsqlp_placeholders_push(&placeholders, location);
+        tsqlp_placeholders_push(&placeholders, location, arena);
     }
     va_end(arg_pointer);
 
-    tsqlp_sql_section_update(chunk, strlen(chunk), placeholders, &section);
+    tsqlp_sql_section_update(chunk, strlen(chunk), placeholders, &section, arena);
 
     return section;
 }
@@ -735,6 +758,35 @@ Test(tsqlp_parse, expression) {
     tsqlp_parse_result_free(parse_result);
 }
 
+Test(tsqlp_parse, operators_continue_after_any_operand) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+
+    const char *sql = "SELECT 1 FROM t WHERE a IS NULL AND b = ALL (SELECT 1) OR c NOT LIKE ? ESCAPE '!' AND "
+                      "d BETWEEN 1 + ? AND 2 XOR e COLLATE utf8_bin = 'x' AND - f * ? ^ 2 != 0";
+
+    cr_assert_eq(PARSE_SQL_STR(sql, parse_result), TSQLP_PARSE_OK);
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("1", 0),
+            SECTION_TABLES, sql_section_new_from_string("t", 0),
+            SECTION_WHERE, sql_section_new_from_string(
+                "a IS NULL AND b = ALL (SELECT 1) OR c NOT LIKE ? ESCAPE '!' AND d BETWEEN 1 + ? AND 2 XOR "
+                "e COLLATE utf8_bin = 'x' AND - f * ? ^ 2 != 0", 3, 47, 78, 125
+            ),
+            NULL
+        )
+    );
+
+    tsqlp_parse_result_free(parse_result);
+    parse_result = tsqlp_parse_result_new();
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT 1 FROM t WHERE a NOT = 1", parse_result), TSQLP_PARSE_INVALID_SYNTAX);
+
+    tsqlp_parse_result_free(parse_result);
+}
+
 Test(tsqlp_parse, column_alias) {
     struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
 
@@ -1242,18 +1294,24 @@ Test(tsqlp_parse, parse_status_string) {
     cr_assert_str_eq(tsqlp_parse_status_to_message(TSQLP_PARSE_OK), "PARSE_OK");
     cr_assert_str_eq(tsqlp_parse_status_to_message(TSQLP_PARSE_ERROR_INVALID_ARGUMENT), "PARSE_ERROR_INVALID_ARGUMENT");
     cr_assert_str_eq(tsqlp_parse_status_to_message(TSQLP_PARSE_INVALID_SYNTAX), "PARSE_INVALID_SYNTAX");
+    cr_assert_str_eq(tsqlp_parse_status_to_message(TSQLP_PARSE_INVALID_UTF8), "PARSE_INVALID_UTF8");
+    cr_assert_str_eq(tsqlp_parse_status_to_message(TSQLP_PARSE_NESTING_TOO_DEEP), "PARSE_NESTING_TOO_DEEP");
+    cr_assert_str_eq(tsqlp_parse_status_to_message(TSQLP_PARSE_SHALLOW), "PARSE_SHALLOW");
+    cr_assert_str_eq(tsqlp_parse_status_to_message(TSQLP_PARSE_ABORTED), "PARSE_ABORTED");
+    cr_assert_str_eq(tsqlp_parse_status_to_message(TSQLP_PARSE_BUFFER_TOO_SMALL), "PARSE_BUFFER_TOO_SMALL");
     cr_assert_str_eq(tsqlp_parse_status_to_message(3232323), "UNKNOWN");
 }
 
 Test(tsqlp_parse, tsqlp_parse_result_serialize) {
     struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+    struct tsqlp_arena *arena = tsqlp_parse_result_arena(parse_result);
 
-    tsqlp_sql_section_update("*", strlen("*"), tsqlp_placeholders_new(), &parse_result->columns);
-    tsqlp_sql_section_update("table t", strlen("table t"), tsqlp_placeholders_new(), &parse_result->tables);
+    tsqlp_sql_section_update("*", strlen("*"), tsqlp_placeholders_new(), &parse_result->columns, arena);
+    tsqlp_sql_section_update("table t", strlen("table t"), tsqlp_placeholders_new(), &parse_result->tables, arena);
 
     struct tsqlp_placeholders where_placeholders = tsqlp_placeholders_new();
-    tsqlp_placeholders_push(&where_placeholders, 4);
-    tsqlp_sql_section_update("a = ?", strlen("a = ?"), where_placeholders, &parse_result->where);
+    tsqlp_placeholders_push(&where_placeholders, 4, arena);
+    tsqlp_sql_section_update("a = ?", strlen("a = ?"), where_placeholders, &parse_result->where, arena);
 
 #define EXPECTED_BUFF_LEN 1024
     char buff[EXPECTED_BUFF_LEN + 1];
@@ -1275,21 +1333,22 @@ Test(tsqlp_parse, tsqlp_parse_result_serialize) {
 
 Test(tsqlp_parse, tsqlp_parse_result_serialize_full) {
     struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+    struct tsqlp_arena *arena = tsqlp_parse_result_arena(parse_result);
 
     tsqlp_sql_section_update("DISTINCT SQL_CACHE", strlen("DISTINCT SQL_CACHE"), tsqlp_placeholders_new(),
-                             &parse_result->modifiers);
+                             &parse_result->modifiers, arena);
     tsqlp_sql_section_update("id, SUM(money) m", strlen("id, SUM(money) n"), tsqlp_placeholders_new(),
-                             &parse_result->columns);
-    tsqlp_sql_section_update("table t", strlen("table t"), tsqlp_placeholders_new(), &parse_result->tables);
-    tsqlp_sql_section_update("a = 1", strlen("a = 1"), tsqlp_placeholders_new(), &parse_result->where);
-    tsqlp_sql_section_update("id ASC", strlen("id ASC"), tsqlp_placeholders_new(), &parse_result->group_by);
-    tsqlp_sql_section_update("money > 0", strlen("money > 0"), tsqlp_placeholders_new(), &parse_result->having);
-    tsqlp_sql_section_update("money DESC", strlen("money DESC"), tsqlp_placeholders_new(), &parse_result->order_by);
-    tsqlp_sql_section_update("1", strlen("1"), tsqlp_placeholders_new(), &parse_result->limit);
+                             &parse_result->columns, arena);
+    tsqlp_sql_section_update("table t", strlen("table t"), tsqlp_placeholders_new(), &parse_result->tables, arena);
+    tsqlp_sql_section_update("a = 1", strlen("a = 1"), tsqlp_placeholders_new(), &parse_result->where, arena);
+    tsqlp_sql_section_update("id ASC", strlen("id ASC"), tsqlp_placeholders_new(), &parse_result->group_by, arena);
+    tsqlp_sql_section_update("money > 0", strlen("money > 0"), tsqlp_placeholders_new(), &parse_result->having, arena);
+    tsqlp_sql_section_update("money DESC", strlen("money DESC"), tsqlp_placeholders_new(), &parse_result->order_by, arena);
+    tsqlp_sql_section_update("1", strlen("1"), tsqlp_placeholders_new(), &parse_result->limit, arena);
     tsqlp_sql_section_update("INTO @user_id, @user_money", strlen("INTO @user_id, @user_money"),
-                             tsqlp_placeholders_new(), &parse_result->second_into);
+                             tsqlp_placeholders_new(), &parse_result->second_into, arena);
     tsqlp_sql_section_update("LOCK IN SHARE MODE", strlen("LOCK IN SHARE MODE"), tsqlp_placeholders_new(),
-                             &parse_result->flags);
+                             &parse_result->flags, arena);
 
 #define EXPECTED_BUFF_LEN 1024
     char buff[EXPECTED_BUFF_LEN + 1];
@@ -1356,3 +1415,1491 @@ Test(tsqlp_parse, placeholder_as_table_name) {
 
     tsqlp_parse_result_free(parse_result);
 }
+
+#define CONCURRENT_THREADS 8
+#define CONCURRENT_ITERATIONS 500
+
+static void *parse_repeatedly(void *arg) {
+    const char *sql = (const char *) arg;
+    size_t failures = 0;
+
+    for (int i = 0; i < CONCURRENT_ITERATIONS; i++) {
+        struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+
+        if (
+            PARSE_SQL_STR(sql, parse_result) != TSQLP_PARSE_OK
+            || parse_result->where.placeholders.count != 1
+            || memcmp(parse_result->tables.chunk, sql + 14, parse_result->tables.len) != 0
+            ) {
+            failures++;
+        }
+
+        tsqlp_parse_result_free(parse_result);
+    }
+
+    return (void *) failures;
+}
+
+Test(tsqlp_parse, concurrent_parses_do_not_interfere) {
+    const char *queries[] = {
+        "SELECT a FROM first_table WHERE a = ?",
+        "SELECT b FROM second_table_with_longer_name t WHERE t.b IN (1, 2, ?)",
+    };
+    pthread_t threads[CONCURRENT_THREADS];
+
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        cr_assert_eq(pthread_create(&threads[i], NULL, parse_repeatedly, (void *) queries[i % 2]), 0);
+    }
+
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        void *failures;
+
+        pthread_join(threads[i], &failures);
+
+        cr_assert_eq((size_t) failures, 0);
+    }
+}
+
+Test(tsqlp_parse, long_literals_and_whitespace) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+
+    cr_assert_eq(
+        PARSE_SQL_STR(
+            "SELECT `a column with a name longer than one vector`\n\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+            "FROM t WHERE a = 'an \\'escaped\\' string, with \\\\ and \" inside, longer than one vector' 'glued' AND b = ?",
+            parse_result
+        ),
+        TSQLP_PARSE_OK
+    );
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("`a column with a name longer than one vector`", 0),
+            SECTION_TABLES, sql_section_new_from_string("t", 0),
+            SECTION_WHERE, sql_section_new_from_string(
+                "a = 'an \\'escaped\\' string, with \\\\ and \" inside, longer than one vector' 'glued' AND b = ?", 1, 90
+            ),
+            NULL
+        )
+    );
+
+    tsqlp_parse_result_free(parse_result);
+
+    parse_result = tsqlp_parse_result_new();
+
+    cr_assert_eq(
+        PARSE_SQL_STR("SELECT 'a string which is never closed, and is longer than one vector \\'", parse_result),
+        TSQLP_PARSE_INVALID_SYNTAX
+    );
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+Test(tsqlp_parse, multi_megabyte_literals, .timeout = 10) {
+    // Long enough for a scanner that rescans or copies a token per chunk read to run into the timeout
+    size_t literal_len = 16 * 1024 * 1024;
+    const char *prefixes[] = {"SELECT '", "SELECT x'", "SELECT 0x"};
+    const char *suffixes[] = {"' FROM t WHERE a = ?", "' FROM t WHERE a = ?", " FROM t WHERE a = ?"};
+    size_t column_lens[] = {literal_len + 2, literal_len + 3, literal_len + 2};
+    char *sql = malloc(literal_len + 32);
+
+    cr_assert_not_null(sql);
+
+    for (size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); i++) {
+        struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+        size_t prefix_len = strlen(prefixes[i]);
+        size_t suffix_len = strlen(suffixes[i]);
+
+        memcpy(sql, prefixes[i], prefix_len);
+        memset(sql + prefix_len, 'F', literal_len);
+        memcpy(sql + prefix_len + literal_len, suffixes[i], suffix_len);
+
+        cr_assert_eq(tsqlp_parse(sql, prefix_len + literal_len + suffix_len, parse_result), TSQLP_PARSE_OK);
+        cr_assert_eq(parse_result->columns.len, column_lens[i]);
+        cr_assert_eq(parse_result->where.placeholders.count, 1);
+
+        tsqlp_parse_result_free(parse_result);
+    }
+
+    free(sql);
+}
+
+Test(tsqlp_parse, utf8) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+
+    cr_assert_eq(
+        PARSE_SQL_STR("SELECT `名前`, prénom, 'ĉu €?' FROM ユーザー AS u WHERE u.città = ? AND @∆ = '😀'", parse_result),
+        TSQLP_PARSE_OK
+    );
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("`名前`, prénom, 'ĉu €?'", 0),
+            SECTION_TABLES, sql_section_new_from_string("ユーザー AS u", 0),
+            SECTION_WHERE, sql_section_new_from_string("u.città = ? AND @∆ = '😀'", 1, 11),
+            NULL
+        )
+    );
+
+    tsqlp_parse_result_free(parse_result);
+
+    // Truncated character, overlong "/", UTF-16 surrogate, code point above U+10FFFF and a stray continuation byte
+    const char *invalid[] = {"SELECT 'caf\xc3'", "SELECT '\xc0\xaf'", "SELECT `\xed\xa0\x80`", "SELECT \xf4\x90\x80\x80", "SELECT a\x80"};
+
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        parse_result = tsqlp_parse_result_new();
+
+        cr_assert_eq(PARSE_SQL_STR(invalid[i], parse_result), TSQLP_PARSE_INVALID_UTF8);
+
+        tsqlp_parse_result_free(parse_result);
+    }
+}
+
+Test(tsqlp_parse, comments_and_optimizer_hints) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+    const char *sql = "/* service=x trace=y */ SELECT /*+ BKA(t) NO_ICP(t) */ a, '-- ?' # c ?\n"
+                      "FROM t -- ?\n"
+                      "WHERE b = ? /* ? */ AND c = '/* ? */'/*+ second */";
+
+    cr_assert_eq(PARSE_SQL_STR(sql, parse_result), TSQLP_PARSE_OK);
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("a, '-- ?'", 0),
+            SECTION_TABLES, sql_section_new_from_string("t", 0),
+            SECTION_WHERE, sql_section_new_from_string("b = ? /* ? */ AND c = '/* ? */'", 1, 4),
+            NULL
+        )
+    );
+
+    struct tsqlp_hints *hints = tsqlp_parse_result_hints(parse_result);
+
+    cr_assert_eq(tsqlp_hints_count(hints), 2);
+    cr_assert_eq(tsqlp_hints_position_at(hints, 0), 31);
+    cr_assert_eq(tsqlp_hints_length_at(hints, 0), 23);
+    cr_assert_eq(tsqlp_hints_position_at(hints, 1), strlen(sql) - 13);
+    cr_assert_eq(tsqlp_hints_length_at(hints, 1), 13);
+
+    tsqlp_parse_result_free(parse_result);
+
+    parse_result = tsqlp_parse_result_new();
+
+    // Not a comment without whitespace after "--"
+    cr_assert_eq(PARSE_SQL_STR("SELECT 1 --2", parse_result), TSQLP_PARSE_OK);
+    cr_assert_eq(parse_result->columns.len, 5);
+
+    tsqlp_parse_result_free(parse_result);
+
+    parse_result = tsqlp_parse_result_new();
+
+    // End of the input counts as whitespace after "--"
+    cr_assert_eq(PARSE_SQL_STR("SELECT 1 --", parse_result), TSQLP_PARSE_OK);
+    cr_assert_eq(parse_result->columns.len, 1);
+
+    tsqlp_parse_result_free(parse_result);
+
+    // Unterminated comment and executable comment
+    const char *invalid[] = {"SELECT 1 /* 2", "SELECT 1 /*! 2 */"};
+
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        parse_result = tsqlp_parse_result_new();
+
+        cr_assert_eq(PARSE_SQL_STR(invalid[i], parse_result), TSQLP_PARSE_INVALID_SYNTAX);
+
+        tsqlp_parse_result_free(parse_result);
+    }
+}
+
+Test(tsqlp_parse, placeholders_of_all_sections_share_a_pool) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+    char sql[1024];
+    size_t len = (size_t) sprintf(sql, "SELECT ?");
+
+    // More placeholders than fit the initial pool in both sections, so the pool grows under an earlier slice
+    for (int i = 1; i < 20; i++) {
+        len += (size_t) sprintf(sql + len, ", ?");
+    }
+
+    len += (size_t) sprintf(sql + len, " FROM t WHERE a IN (?");
+
+    for (int i = 1; i < 100; i++) {
+        len += (size_t) sprintf(sql + len, ", ?");
+    }
+
+    len += (size_t) sprintf(sql + len, ")");
+
+    // The shallow scan collects them the same way
+    for (int shallow = 0; shallow < 2; shallow++) {
+        if (shallow) {
+            cr_assert_eq(tsqlp_parse_shallow(sql, len, parse_result), TSQLP_PARSE_OK);
+        } else {
+            cr_assert_eq(tsqlp_parse(sql, len, parse_result), TSQLP_PARSE_OK);
+        }
+
+        cr_assert_eq(parse_result->columns.placeholders.count, 20);
+        cr_assert_eq(parse_result->where.placeholders.count, 100);
+
+        for (size_t i = 0; i < 20; i++) {
+            cr_assert_eq(parse_result->columns.placeholders.locations[i], i * 3);
+        }
+
+        for (size_t i = 0; i < 100; i++) {
+            cr_assert_eq(parse_result->where.placeholders.locations[i], 6 + i * 3);
+        }
+    }
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+Test(tsqlp_parse, subqueries) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+
+    cr_assert_eq(
+        PARSE_SQL_STR(
+            "SELECT a, (SELECT ? FROM u) FROM (SELECT b FROM v WHERE c IN (SELECT ? FROM w)) AS x "
+            "WHERE EXISTS (SELECT 1 FROM y WHERE z = ?)",
+            parse_result
+        ),
+        TSQLP_PARSE_OK
+    );
+
+    // Sections of the statement keep the placeholders of its subqueries
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("a, (SELECT ? FROM u)", 1, 11),
+            SECTION_TABLES, sql_section_new_from_string("(SELECT b FROM v WHERE c IN (SELECT ? FROM w)) AS x", 1, 36),
+            SECTION_WHERE, sql_section_new_from_string("EXISTS (SELECT 1 FROM y WHERE z = ?)", 1, 34),
+            NULL
+        )
+    );
+
+    struct tsqlp_subqueries *subqueries = tsqlp_parse_result_subqueries(parse_result);
+
+    cr_assert_eq(tsqlp_subqueries_count(subqueries), 3);
+    cr_assert_null(tsqlp_subqueries_at(subqueries, 3));
+
+    struct tsqlp_subquery *subquery = tsqlp_subqueries_at(subqueries, 0);
+
+    cr_assert_eq(subquery->offset, 11);
+    cr_assert_eq(subquery->len, 15);
+    assert_parse_result_eq(
+        subquery->parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("?", 1, 0),
+            SECTION_TABLES, sql_section_new_from_string("u", 0),
+            NULL
+        )
+    );
+
+    subquery = tsqlp_subqueries_at(subqueries, 1);
+
+    cr_assert_eq(subquery->offset, 34);
+    cr_assert_eq(subquery->len, 44);
+    assert_parse_result_eq(
+        subquery->parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("b", 0),
+            SECTION_TABLES, sql_section_new_from_string("v", 0),
+            SECTION_WHERE, sql_section_new_from_string("c IN (SELECT ? FROM w)", 1, 13),
+            NULL
+        )
+    );
+    cr_assert_eq(tsqlp_subqueries_count(&subquery->parse_result->subqueries), 1);
+
+    subquery = tsqlp_subqueries_at(&subquery->parse_result->subqueries, 0);
+
+    cr_assert_eq(subquery->offset, 62);
+    cr_assert_eq(subquery->len, 15);
+    cr_assert_eq(subquery->parse_result->columns.placeholders.locations[0], 0);
+    cr_assert_eq(tsqlp_subqueries_count(&subquery->parse_result->subqueries), 0);
+
+    subquery = tsqlp_subqueries_at(subqueries, 2);
+
+    cr_assert_eq(subquery->offset, 99);
+    cr_assert_eq(subquery->len, 27);
+    assert_parse_result_eq(
+        subquery->parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("1", 0),
+            SECTION_TABLES, sql_section_new_from_string("y", 0),
+            SECTION_WHERE, sql_section_new_from_string("z = ?", 1, 4),
+            NULL
+        )
+    );
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+Test(tsqlp_parse, reused_result_starts_over) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT a FROM (SELECT ?) d WHERE b = ?", parse_result), TSQLP_PARSE_OK);
+    cr_assert_eq(tsqlp_subqueries_count(tsqlp_parse_result_subqueries(parse_result)), 1);
+
+    // Subqueries of the previous statement are not kept
+    cr_assert_eq(PARSE_SQL_STR("SELECT c FROM t WHERE e IN (SELECT 1, ?)", parse_result), TSQLP_PARSE_OK);
+    cr_assert_eq(tsqlp_subqueries_count(tsqlp_parse_result_subqueries(parse_result)), 1);
+
+    struct tsqlp_subquery *subquery = tsqlp_subqueries_at(tsqlp_parse_result_subqueries(parse_result), 0);
+
+    cr_assert_eq(subquery->offset, 28);
+    cr_assert_eq(subquery->len, 11);
+
+    // Neither are its sections
+    cr_assert_eq(PARSE_SQL_STR("SELECT a FROM t WHERE b = ? ORDER BY c", parse_result), TSQLP_PARSE_OK);
+    cr_assert_eq(PARSE_SQL_STR("SELECT 1", parse_result), TSQLP_PARSE_OK);
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("1", 0),
+            NULL
+        )
+    );
+    cr_assert_eq(tsqlp_subqueries_count(tsqlp_parse_result_subqueries(parse_result)), 0);
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT /*+ BKA(t) */ a FROM t WHERE b = ?", parse_result), TSQLP_PARSE_OK);
+    cr_assert_eq(tsqlp_parse_shallow("SELECT c", 8, parse_result), TSQLP_PARSE_OK);
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("c", 0),
+            NULL
+        )
+    );
+    cr_assert_eq(tsqlp_hints_count(tsqlp_parse_result_hints(parse_result)), 0);
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+Test(tsqlp_parse, requested_sections) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+
+    tsqlp_parse_result_set_sections(parse_result, TSQLP_SECTION_TABLES);
+
+    // Parsing stops after the tables, the rest is never looked at
+    cr_assert_eq(
+        PARSE_SQL_STR("SELECT a, ? FROM t, (SELECT ? FROM u WHERE v = ?) AS x WHERE b = ? LIMIT -", parse_result),
+        TSQLP_PARSE_OK
+    );
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_TABLES, sql_section_new_from_string("t, (SELECT ? FROM u WHERE v = ?) AS x", 2, 11, 30),
+            NULL
+        )
+    );
+
+    cr_assert_eq(tsqlp_subqueries_count(&parse_result->subqueries), 1);
+    assert_parse_result_eq(
+        parse_result->subqueries.items[0].parse_result,
+        make_parse_result(
+            SECTION_TABLES, sql_section_new_from_string("u", 0),
+            NULL
+        )
+    );
+
+    tsqlp_parse_result_free(parse_result);
+    parse_result = tsqlp_parse_result_new();
+
+    tsqlp_parse_result_set_sections(parse_result, TSQLP_SECTION_WHERE | TSQLP_SECTION_LIMIT);
+
+    cr_assert_eq(
+        PARSE_SQL_STR("SELECT (SELECT ?) FROM t WHERE b = ? ORDER BY c LIMIT ?, 10 FOR UPDATE", parse_result),
+        TSQLP_PARSE_OK
+    );
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_WHERE, sql_section_new_from_string("b = ?", 1, 4),
+            SECTION_LIMIT, sql_section_new_from_string("?, 10", 1, 0),
+            NULL
+        )
+    );
+
+    // Subqueries of sections which were not requested are not recorded
+    cr_assert_eq(tsqlp_subqueries_count(&parse_result->subqueries), 0);
+
+    // Sections before the last requested one are still checked
+    cr_assert_eq(PARSE_SQL_STR("SELECT a FROM t WHERE b = LIMIT 1", parse_result), TSQLP_PARSE_INVALID_SYNTAX);
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+Test(tsqlp_parse, syntax_error_position) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+    struct tsqlp_syntax_error syntax_error;
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT 1 FROM t WHERE a BETWEEN 1 OR 2", parse_result), TSQLP_PARSE_INVALID_SYNTAX);
+    cr_assert_eq(tsqlp_parse_result_syntax_error(parse_result, &syntax_error), 1);
+    cr_assert_eq(syntax_error.token.type, TSQLP_TOKEN_KEYWORD);
+    cr_assert_eq(syntax_error.token.offset, 34);
+    cr_assert_eq(syntax_error.token.len, 2);
+    cr_assert_eq(syntax_error.expected, TSQLP_TOKEN_KEYWORD);
+
+    tsqlp_parse_result_free(parse_result);
+    parse_result = tsqlp_parse_result_new();
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT COUNT(1", parse_result), TSQLP_PARSE_INVALID_SYNTAX);
+    cr_assert_eq(tsqlp_parse_result_syntax_error(parse_result, &syntax_error), 1);
+    cr_assert_eq(syntax_error.token.offset, 14);
+    cr_assert_eq(syntax_error.token.len, 0);
+    cr_assert_eq(syntax_error.expected, TSQLP_TOKEN_CLOSE_PAREN);
+
+    tsqlp_parse_result_free(parse_result);
+    parse_result = tsqlp_parse_result_new();
+
+    // Left over token, anything could have been expected
+    cr_assert_eq(PARSE_SQL_STR("SELECT 1 FROM t 2", parse_result), TSQLP_PARSE_INVALID_SYNTAX);
+    cr_assert_eq(tsqlp_parse_result_syntax_error(parse_result, &syntax_error), 1);
+    cr_assert_eq(syntax_error.token.type, TSQLP_TOKEN_NUMBER);
+    cr_assert_eq(syntax_error.token.offset, 16);
+    cr_assert_eq(syntax_error.expected, TSQLP_TOKEN_UNKNOWN);
+
+    tsqlp_parse_result_free(parse_result);
+    parse_result = tsqlp_parse_result_new();
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT 1", parse_result), TSQLP_PARSE_OK);
+    cr_assert_eq(tsqlp_parse_result_syntax_error(parse_result, &syntax_error), 0);
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+Test(tsqlp_parse, shallow_scan) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+    const char *sql = "SELECT a, ? FROM t USE INDEX FOR ORDER BY (i) WHERE b IN (SELECT c FROM u WHERE d = ?) "
+                      "ORDER BY a LIMIT ? FOR UPDATE";
+
+    cr_assert_eq(tsqlp_parse_shallow(sql, strlen(sql), parse_result), TSQLP_PARSE_OK);
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("a, ?", 1, 3),
+            SECTION_TABLES, sql_section_new_from_string("t USE INDEX FOR ORDER BY (i)", 0),
+            SECTION_WHERE, sql_section_new_from_string("b IN (SELECT c FROM u WHERE d = ?)", 1, 32),
+            SECTION_ORDER_BY, sql_section_new_from_string("a", 0),
+            SECTION_LIMIT, sql_section_new_from_string("?", 1, 0),
+            SECTION_FLAGS, sql_section_new_from_string("FOR UPDATE", 0),
+            NULL
+        )
+    );
+
+    // Subqueries are not looked into
+    cr_assert_eq(tsqlp_subqueries_count(&parse_result->subqueries), 0);
+
+    cr_assert_eq(tsqlp_parse_shallow("SELECT a FROM (t", 16, parse_result), TSQLP_PARSE_INVALID_SYNTAX);
+    cr_assert_eq(tsqlp_parse_shallow("SELECT a FROM t WHERE", 21, parse_result), TSQLP_PARSE_INVALID_SYNTAX);
+
+    tsqlp_parse_result_free(parse_result);
+    parse_result = tsqlp_parse_result_new();
+
+    // Without the fallback a statement the grammar rejects has no sections
+    cr_assert_eq(
+        PARSE_SQL_STR("SELECT a FROM t WHERE b = ? ORDER BY c ASC DESC LIMIT ?", parse_result),
+        TSQLP_PARSE_INVALID_SYNTAX
+    );
+
+    tsqlp_parse_result_set_shallow_fallback(parse_result, 1);
+
+    cr_assert_eq(
+        PARSE_SQL_STR("SELECT a FROM t WHERE b = ? ORDER BY c ASC DESC LIMIT ?", parse_result),
+        TSQLP_PARSE_SHALLOW
+    );
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("a", 0),
+            SECTION_TABLES, sql_section_new_from_string("t", 0),
+            SECTION_WHERE, sql_section_new_from_string("b = ?", 1, 4),
+            SECTION_ORDER_BY, sql_section_new_from_string("c ASC DESC", 0),
+            SECTION_LIMIT, sql_section_new_from_string("?", 1, 0),
+            NULL
+        )
+    );
+
+    // The grammar error is still reported
+    struct tsqlp_syntax_error syntax_error;
+
+    cr_assert_eq(tsqlp_parse_result_syntax_error(parse_result, &syntax_error), 1);
+    cr_assert_eq(syntax_error.token.offset, 43);
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT a FROM t WHERE (b", parse_result), TSQLP_PARSE_INVALID_SYNTAX);
+    cr_assert_eq(PARSE_SQL_STR("SELECT a FROM t", parse_result), TSQLP_PARSE_OK);
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+Test(tsqlp_parse, nesting_limit) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+    size_t terms = 50000;
+    char *sql = malloc(terms * strlen(" OR a = ?") + 64);
+    size_t len = (size_t) sprintf(sql, "SELECT * FROM t WHERE a = ?");
+
+    // Operator chains do not nest, however long they are
+    for (size_t i = 1; i < terms; i++) {
+        len += (size_t) sprintf(sql + len, " OR a = ?");
+    }
+
+    cr_assert_eq(tsqlp_parse(sql, len, parse_result), TSQLP_PARSE_OK);
+    cr_assert_eq(parse_result->where.placeholders.count, terms);
+
+    tsqlp_parse_result_free(parse_result);
+    parse_result = tsqlp_parse_result_new();
+
+    len = (size_t) sprintf(sql, "SELECT ");
+    memset(sql + len, '(', terms);
+    sql[len + terms] = '1';
+    memset(sql + len + terms + 1, ')', terms);
+    len += 2 * terms + 1;
+
+    cr_assert_eq(tsqlp_parse(sql, len, parse_result), TSQLP_PARSE_NESTING_TOO_DEEP);
+
+    tsqlp_parse_result_free(parse_result);
+    free(sql);
+
+    parse_result = tsqlp_parse_result_new();
+    sql = malloc(terms * strlen(" + ?") + 64);
+    len = (size_t) sprintf(sql, "SELECT ?");
+
+    for (size_t i = 1; i < terms; i++) {
+        len += (size_t) sprintf(sql + len, " + ?");
+    }
+
+    cr_assert_eq(tsqlp_parse(sql, len, parse_result), TSQLP_PARSE_OK);
+    cr_assert_eq(parse_result->columns.placeholders.count, terms);
+
+    tsqlp_parse_result_free(parse_result);
+    free(sql);
+
+    // Statement, columns expression and one level per parenthesis
+    parse_result = tsqlp_parse_result_new();
+    tsqlp_parse_result_set_max_depth(parse_result, 3);
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT ((1))", parse_result), TSQLP_PARSE_NESTING_TOO_DEEP);
+
+    tsqlp_parse_result_set_max_depth(parse_result, 4);
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT ((1))", parse_result), TSQLP_PARSE_OK);
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+Test(tsqlp_parse, section_views) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new_with_views();
+    const char *sql = "SELECT a, ? FROM t WHERE b = ? ORDER BY c";
+
+    cr_assert_eq(PARSE_SQL_STR(sql, parse_result), TSQLP_PARSE_OK);
+
+    cr_assert_eq(parse_result->columns.chunk, sql + 7);
+    cr_assert_eq(parse_result->tables.chunk, sql + 17);
+    cr_assert_eq(parse_result->where.chunk, sql + 25);
+    cr_assert_eq(parse_result->order_by.chunk, sql + 40);
+
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("a, ?", 1, 3),
+            SECTION_TABLES, sql_section_new_from_string("t", 0),
+            SECTION_WHERE, sql_section_new_from_string("b = ?", 1, 4),
+            SECTION_ORDER_BY, sql_section_new_from_string("c", 0),
+            NULL
+        )
+    );
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+static struct tsqlp_ast_node *
+assert_ast_node(const struct tsqlp_ast *ast, const struct tsqlp_ast_node *parent, size_t index, tsqlp_ast_node_type type,
+                size_t offset, size_t len, size_t child_count) {
+    cr_assert_lt(index, parent->child_count);
+
+    struct tsqlp_ast_node *node = tsqlp_ast_at(ast, parent->first_child + index);
+
+    cr_assert_not_null(node);
+    cr_assert_eq(node->type, type);
+    cr_assert_eq(node->offset, offset);
+    cr_assert_eq(node->len, len);
+    cr_assert_eq(node->child_count, child_count);
+
+    return node;
+}
+
+Test(tsqlp_parse, ast) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+    const char *sql = "SELECT a + b * ? AS x FROM t JOIN u ON t.id = u.id WHERE c IN (SELECT 1)";
+
+    // Not built unless asked for
+    cr_assert_eq(PARSE_SQL_STR(sql, parse_result), TSQLP_PARSE_OK);
+    cr_assert_eq(tsqlp_ast_count(tsqlp_parse_result_ast(parse_result)), 0);
+
+    tsqlp_parse_result_set_ast(parse_result, 1);
+
+    cr_assert_eq(PARSE_SQL_STR(sql, parse_result), TSQLP_PARSE_OK);
+
+    struct tsqlp_ast *ast = tsqlp_parse_result_ast(parse_result);
+
+    cr_assert_eq(tsqlp_ast_count(ast), 23);
+    cr_assert_null(tsqlp_ast_at(ast, 23));
+
+    struct tsqlp_ast_node *root = tsqlp_ast_at(ast, 22);
+
+    cr_assert_eq(root->type, TSQLP_AST_STATEMENT);
+    cr_assert_eq(root->offset, 0);
+    cr_assert_eq(root->len, strlen(sql));
+    cr_assert_eq(root->child_count, 3);
+
+    struct tsqlp_ast_node *section = assert_ast_node(ast, root, 0, TSQLP_AST_SECTION, 7, 14, 2);
+
+    cr_assert_eq(section->section, TSQLP_SECTION_COLUMNS);
+
+    struct tsqlp_ast_node *node = assert_ast_node(ast, section, 0, TSQLP_AST_OPERATOR, 7, 9, 2);
+
+    assert_ast_node(ast, node, 0, TSQLP_AST_IDENTIFIER, 7, 1, 0);
+    node = assert_ast_node(ast, node, 1, TSQLP_AST_OPERATOR, 11, 5, 2);
+    assert_ast_node(ast, node, 0, TSQLP_AST_IDENTIFIER, 11, 1, 0);
+    assert_ast_node(ast, node, 1, TSQLP_AST_PLACEHOLDER, 15, 1, 0);
+    assert_ast_node(ast, section, 1, TSQLP_AST_ALIAS, 20, 1, 0);
+
+    section = assert_ast_node(ast, root, 1, TSQLP_AST_SECTION, 27, 23, 1);
+
+    cr_assert_eq(section->section, TSQLP_SECTION_TABLES);
+
+    struct tsqlp_ast_node *join = assert_ast_node(ast, section, 0, TSQLP_AST_JOIN, 27, 23, 3);
+
+    node = assert_ast_node(ast, join, 0, TSQLP_AST_TABLE, 27, 1, 1);
+    assert_ast_node(ast, node, 0, TSQLP_AST_IDENTIFIER, 27, 1, 0);
+    node = assert_ast_node(ast, join, 1, TSQLP_AST_TABLE, 34, 1, 1);
+    assert_ast_node(ast, node, 0, TSQLP_AST_IDENTIFIER, 34, 1, 0);
+    node = assert_ast_node(ast, join, 2, TSQLP_AST_OPERATOR, 39, 11, 2);
+    assert_ast_node(ast, node, 0, TSQLP_AST_IDENTIFIER, 39, 4, 0);
+    assert_ast_node(ast, node, 1, TSQLP_AST_IDENTIFIER, 46, 4, 0);
+
+    section = assert_ast_node(ast, root, 2, TSQLP_AST_SECTION, 57, 15, 1);
+
+    cr_assert_eq(section->section, TSQLP_SECTION_WHERE);
+
+    // Subqueries are statements of the same AST
+    node = assert_ast_node(ast, section, 0, TSQLP_AST_OPERATOR, 57, 15, 2);
+    assert_ast_node(ast, node, 0, TSQLP_AST_IDENTIFIER, 57, 1, 0);
+    node = assert_ast_node(ast, node, 1, TSQLP_AST_STATEMENT, 63, 8, 1);
+    node = assert_ast_node(ast, node, 0, TSQLP_AST_SECTION, 70, 1, 1);
+    assert_ast_node(ast, node, 0, TSQLP_AST_LITERAL, 70, 1, 0);
+
+    cr_assert_eq(tsqlp_ast_count(&parse_result->subqueries.items[0].parse_result->ast), 0);
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT a FROM", parse_result), TSQLP_PARSE_INVALID_SYNTAX);
+    cr_assert_eq(tsqlp_ast_count(ast), 0);
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+Test(tsqlp_parse, null_safe_equality_binds_like_a_comparison) {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+
+    tsqlp_parse_result_set_ast(parse_result, 1);
+
+    cr_assert_eq(PARSE_SQL_STR("SELECT a <=> b + 1", parse_result), TSQLP_PARSE_OK);
+
+    struct tsqlp_ast *ast = tsqlp_parse_result_ast(parse_result);
+    struct tsqlp_ast_node *root = tsqlp_ast_at(ast, tsqlp_ast_count(ast) - 1);
+    struct tsqlp_ast_node *section = assert_ast_node(ast, root, 0, TSQLP_AST_SECTION, 7, 11, 1);
+    struct tsqlp_ast_node *node = assert_ast_node(ast, section, 0, TSQLP_AST_OPERATOR, 7, 11, 2);
+
+    assert_ast_node(ast, node, 0, TSQLP_AST_IDENTIFIER, 7, 1, 0);
+    node = assert_ast_node(ast, node, 1, TSQLP_AST_OPERATOR, 13, 5, 2);
+    assert_ast_node(ast, node, 0, TSQLP_AST_IDENTIFIER, 13, 1, 0);
+    assert_ast_node(ast, node, 1, TSQLP_AST_LITERAL, 17, 1, 0);
+
+    tsqlp_parse_result_free(parse_result);
+}
+
+Test(tsqlp_parse, into_buffer) {
+    static char buffer[4096];
+    const char *sql = "SELECT /*+ BKA(t) */ a, ? FROM t WHERE b IN (SELECT ? FROM u)";
+    struct tsqlp_parse_result *parse_result;
+    size_t required;
+
+    cr_assert_eq(tsqlp_parse_into(sql, strlen(sql), buffer, 64, &parse_result, &required), TSQLP_PARSE_BUFFER_TOO_SMALL);
+    cr_assert_null(parse_result);
+    cr_assert_lt(required, sizeof(buffer));
+    cr_assert_leq(required, tsqlp_parse_into_bound(strlen(sql)));
+
+    size_t needed = required;
+
+    cr_assert_eq(tsqlp_parse_into(sql, strlen(sql), buffer + 1, needed, &parse_result, &required), TSQLP_PARSE_OK);
+    cr_assert_leq(required, needed);
+    cr_assert_geq((char *) parse_result->where.chunk, buffer + 1);
+    cr_assert_lt((char *) parse_result->where.chunk, buffer + 1 + needed);
+    cr_assert_eq(tsqlp_hints_count(tsqlp_parse_result_hints(parse_result)), 1);
+    cr_assert_eq(tsqlp_subqueries_count(tsqlp_parse_result_subqueries(parse_result)), 1);
+    assert_parse_result_eq(
+        tsqlp_subqueries_at(tsqlp_parse_result_subqueries(parse_result), 0)->parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("?", 1, 0),
+            SECTION_TABLES, sql_section_new_from_string("u", 0),
+            NULL
+        )
+    );
+    assert_parse_result_eq(
+        parse_result,
+        make_parse_result(
+            SECTION_COLUMNS, sql_section_new_from_string("a, ?", 1, 3),
+            SECTION_TABLES, sql_section_new_from_string("t", 0),
+            SECTION_WHERE, sql_section_new_from_string("b IN (SELECT ? FROM u)", 1, 13),
+            NULL
+        )
+    );
+
+    needed = required;
+
+    // Result itself fits, its sections do not
+    cr_assert_eq(
+        tsqlp_parse_into(sql, strlen(sql), buffer + 1, needed - 32, &parse_result, &required),
+        TSQLP_PARSE_BUFFER_TOO_SMALL
+    );
+    cr_assert_null(parse_result);
+    cr_assert_geq(required, needed);
+
+    sql = "SELECT a FROM";
+
+    cr_assert_eq(
+        tsqlp_parse_into(sql, strlen(sql), buffer, sizeof(buffer), &parse_result, &required),
+        TSQLP_PARSE_INVALID_SYNTAX
+    );
+    cr_assert_not_null(parse_result);
+}
+
+enum bound_statement {
+    BOUND_FLAT_LITERAL,
+    BOUND_FLAT_PLACEHOLDERS,
+    BOUND_FLAT_HINTS,
+    BOUND_NESTED_PLACEHOLDERS,
+    BOUND_NESTED_HINTS,
+    BOUND_STATEMENT_KINDS
+};
+
+// Statement of the given kind and at most len bytes, nested ones as deep as len and the nesting limit allow
+static size_t make_bound_statement(char *sql, enum bound_statement kind, size_t len) {
+    size_t n = 0;
+    size_t depth = 0;
+
+    switch (kind) {
+        case BOUND_FLAT_LITERAL:
+            n = sprintf(sql, "SELECT a FROM t WHERE b = '");
+            while (n + 1 < len) {
+                sql[n++] = 'x';
+            }
+            sql[n++] = '\'';
+            break;
+        case BOUND_FLAT_PLACEHOLDERS:
+            n = sprintf(sql, "SELECT a FROM t WHERE b IN (?");
+            while (n + 3 < len) {
+                n += sprintf(sql + n, ",?");
+            }
+            sql[n++] = ')';
+            break;
+        case BOUND_FLAT_HINTS:
+            n = sprintf(sql, "SELECT ");
+            while (n + 6 < len) {
+                n += sprintf(sql + n, "/*+*/");
+            }
+            sql[n++] = '1';
+            break;
+        case BOUND_NESTED_PLACEHOLDERS:
+            for (depth = 0; depth < (len - 10) / 8 && depth < 84; depth++) {
+                n += sprintf(sql + n, "SELECT(");
+            }
+            n += sprintf(sql + n, "SELECT ?");
+            while (n + depth + 2 < len) {
+                n += sprintf(sql + n, ",?");
+            }
+            memset(sql + n, ')', depth);
+            n += depth;
+            break;
+        case BOUND_NESTED_HINTS:
+            for (depth = 0; depth < (len - 20) / 14 && depth < 254; depth++) {
+                n += sprintf(sql + n, "SELECT*FROM(");
+            }
+            n += sprintf(sql + n, "SELECT ");
+            while (n + 2 * depth + 6 < len) {
+                n += sprintf(sql + n, "/*+*/");
+            }
+            sql[n++] = '1';
+            for (size_t i = 0; i < depth; i++) {
+                n += sprintf(sql + n, ")d");
+            }
+            break;
+        default:
+            break;
+    }
+
+    return n;
+}
+
+Test(tsqlp_parse, into_buffer_bound) {
+    static char sql[4096 + 16];
+    size_t lens[] = {32, 256, 4096};
+    struct tsqlp_parse_result *parse_result;
+    size_t required;
+
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        double tightest = 0;
+
+        for (enum bound_statement kind = 0; kind < BOUND_STATEMENT_KINDS; kind++) {
+            size_t len = make_bound_statement(sql, kind, lens[i]);
+            size_t bound = tsqlp_parse_into_bound(len);
+            void *buffer = malloc(bound);
+
+            cr_assert_leq(len, lens[i]);
+            cr_assert_eq(tsqlp_parse_into(sql, len, buffer, bound, &parse_result, &required), TSQLP_PARSE_OK);
+            cr_assert_leq(required, bound);
+
+            double factor = (double) bound / required;
+
+            // Short flat statements are not paid for the nesting they could have
+            if (kind <= BOUND_FLAT_HINTS && lens[i] <= 32) {
+                cr_assert_leq(factor, 8);
+            }
+
+            tightest = tightest == 0 || factor < tightest ? factor : tightest;
+            free(buffer);
+        }
+
+        // Statements nested as deep as their length allows need most of the bound
+        cr_assert_leq(tightest, 4);
+    }
+}
+
+Test(tsqlp_validate, checks_the_grammar_and_counts_placeholders) {
+    size_t placeholder_count = 0;
+
+    const char *sql = "SELECT ?, a FROM t WHERE b IN (SELECT ? FROM u) LIMIT ?";
+
+    cr_assert_eq(tsqlp_validate(sql, strlen(sql), &placeholder_count), TSQLP_PARSE_OK);
+    cr_assert_eq(placeholder_count, 3);
+
+    cr_assert_eq(tsqlp_validate("SELECT ? FROM t WHERE", 21, &placeholder_count), TSQLP_PARSE_INVALID_SYNTAX);
+    cr_assert_eq(placeholder_count, 0);
+
+    cr_assert_eq(tsqlp_validate("SELECT 1 FROM t 2", 17, NULL), TSQLP_PARSE_INVALID_SYNTAX);
+    cr_assert_eq(tsqlp_validate("SELECT /*+ BKA(t) */ 1", 22, NULL), TSQLP_PARSE_OK);
+    cr_assert_eq(tsqlp_validate("SELECT '\xff'", 10, NULL), TSQLP_PARSE_INVALID_UTF8);
+    cr_assert_eq(tsqlp_validate(NULL, 0, NULL), TSQLP_PARSE_ERROR_INVALID_ARGUMENT);
+}
+
+#define RECORDED_EVENTS_MAX 32
+
+struct recorded_events {
+    struct tsqlp_event events[RECORDED_EVENTS_MAX];
+    size_t count;
+    // Callback asks to stop once this many events were recorded, 0 to never stop
+    size_t stop_after;
+};
+
+static int record_event(const struct tsqlp_event *event, void *user_data) {
+    struct recorded_events *recorded = (struct recorded_events *) user_data;
+
+    if (recorded->count < RECORDED_EVENTS_MAX) {
+        recorded->events[recorded->count] = *event;
+    }
+
+    recorded->count++;
+
+    return recorded->stop_after > 0 && recorded->count >= recorded->stop_after;
+}
+
+Test(tsqlp_parse_events, reports_events_in_statement_order) {
+    const char *sql = "SELECT a, ? FROM t WHERE b IN (SELECT 1) LIMIT 5";
+    struct recorded_events recorded = {.count = 0, .stop_after = 0};
+    struct {
+        tsqlp_event_type type;
+        unsigned int section;
+        unsigned int depth;
+        size_t offset;
+        size_t len;
+    } expected[] = {
+        {TSQLP_EVENT_SECTION_START, TSQLP_SECTION_COLUMNS, 0, 7, 0},
+        {TSQLP_EVENT_IDENTIFIER, TSQLP_SECTION_COLUMNS, 0, 7, 1},
+        {TSQLP_EVENT_PLACEHOLDER, TSQLP_SECTION_COLUMNS, 0, 10, 1},
+        {TSQLP_EVENT_SECTION_END, TSQLP_SECTION_COLUMNS, 0, 7, 4},
+        {TSQLP_EVENT_SECTION_START, TSQLP_SECTION_TABLES, 0, 17, 0},
+        {TSQLP_EVENT_IDENTIFIER, TSQLP_SECTION_TABLES, 0, 17, 1},
+        {TSQLP_EVENT_SECTION_END, TSQLP_SECTION_TABLES, 0, 17, 1},
+        {TSQLP_EVENT_SECTION_START, TSQLP_SECTION_WHERE, 0, 25, 0},
+        {TSQLP_EVENT_IDENTIFIER, TSQLP_SECTION_WHERE, 0, 25, 1},
+        {TSQLP_EVENT_SUBQUERY_START, TSQLP_SECTION_WHERE, 0, 31, 0},
+        {TSQLP_EVENT_SECTION_START, TSQLP_SECTION_COLUMNS, 1, 38, 0},
+        {TSQLP_EVENT_LITERAL, TSQLP_SECTION_COLUMNS, 1, 38, 1},
+        {TSQLP_EVENT_SECTION_END, TSQLP_SECTION_COLUMNS, 1, 38, 1},
+        {TSQLP_EVENT_SUBQUERY_END, TSQLP_SECTION_WHERE, 0, 31, 8},
+        {TSQLP_EVENT_SECTION_END, TSQLP_SECTION_WHERE, 0, 25, 15},
+        {TSQLP_EVENT_SECTION_START, TSQLP_SECTION_LIMIT, 0, 47, 0},
+        {TSQLP_EVENT_LITERAL, TSQLP_SECTION_LIMIT, 0, 47, 1},
+        {TSQLP_EVENT_SECTION_END, TSQLP_SECTION_LIMIT, 0, 47, 1},
+    };
+    size_t expected_count = sizeof(expected) / sizeof(expected[0]);
+
+    cr_assert_eq(tsqlp_parse_events(sql, strlen(sql), record_event, &recorded), TSQLP_PARSE_OK);
+    cr_assert_eq(recorded.count, expected_count);
+
+    for (size_t i = 0; i < expected_count; i++) {
+        cr_assert_eq(recorded.events[i].type, expected[i].type, "event %zu", i);
+        cr_assert_eq(recorded.events[i].section, expected[i].section, "event %zu", i);
+        cr_assert_eq(recorded.events[i].depth, expected[i].depth, "event %zu", i);
+        cr_assert_eq(recorded.events[i].token.offset, expected[i].offset, "event %zu", i);
+        cr_assert_eq(recorded.events[i].token.len, expected[i].len, "event %zu", i);
+    }
+
+    // Stops right away once the callback asks to
+    recorded = (struct recorded_events) {.count = 0, .stop_after = 3};
+
+    cr_assert_eq(tsqlp_parse_events(sql, strlen(sql), record_event, &recorded), TSQLP_PARSE_ABORTED);
+    cr_assert_eq(recorded.count, 3);
+
+    recorded = (struct recorded_events) {.count = 0, .stop_after = 0};
+
+    cr_assert_eq(tsqlp_parse_events("SELECT 1 FROM", 13, record_event, &recorded), TSQLP_PARSE_INVALID_SYNTAX);
+    cr_assert_eq(tsqlp_parse_events("SELECT 1", 8, NULL, NULL), TSQLP_PARSE_ERROR_INVALID_ARGUMENT);
+}
+
+Test(tsqlp_parser, parses_statements_one_after_another) {
+    struct tsqlp_parser *parser = tsqlp_parser_new();
+
+    for (int round = 0; round < 2; round++) {
+        cr_assert_eq(tsqlp_parser_parse(parser, "SELECT a, ? FROM t WHERE b = ?", strlen("SELECT a, ? FROM t WHERE b = ?")), TSQLP_PARSE_OK);
+
+        assert_parse_result_eq(
+            tsqlp_parser_result(parser),
+            make_parse_result(
+                SECTION_COLUMNS, sql_section_new_from_string("a, ?", 1, 3),
+                SECTION_TABLES, sql_section_new_from_string("t", 0),
+                SECTION_WHERE, sql_section_new_from_string("b = ?", 1, 4),
+                NULL
+            )
+        );
+
+        cr_assert_eq(tsqlp_parser_parse(parser, "SELECT FROM", strlen("SELECT FROM")), TSQLP_PARSE_INVALID_SYNTAX);
+        cr_assert_eq(tsqlp_parser_parse(parser, NULL, 0), TSQLP_PARSE_ERROR_INVALID_ARGUMENT);
+
+        // Nothing is left over from the previous statements
+        cr_assert_eq(tsqlp_parser_parse(parser, "SELECT /*+ BKA(t) */ 1", strlen("SELECT /*+ BKA(t) */ 1")), TSQLP_PARSE_OK);
+
+        assert_parse_result_eq(
+            tsqlp_parser_result(parser),
+            make_parse_result(
+                SECTION_COLUMNS, sql_section_new_from_string("1", 0),
+                NULL
+            )
+        );
+        cr_assert_eq(tsqlp_hints_count(tsqlp_parse_result_hints(tsqlp_parser_result(parser))), 1);
+    }
+
+    tsqlp_parser_free(parser);
+}
+
+Test(tsqlp_tokenizer, token_stream) {
+    const char *sql = "SELECT /*+ hint */ t.a, 'x' -- c\nFROM `t` WHERE @v >= ? #";
+    struct {
+        tsqlp_token_type type;
+        const char *text;
+    } expected[] = {
+        {TSQLP_TOKEN_KEYWORD, "SELECT"},
+        {TSQLP_TOKEN_WHITE_SPACE, " "},
+        {TSQLP_TOKEN_OPTIMIZER_HINT, "/*+ hint */"},
+        {TSQLP_TOKEN_WHITE_SPACE, " "},
+        {TSQLP_TOKEN_QUALIFIED_IDENTIFIER, "t.a"},
+        {TSQLP_TOKEN_COMMA, ","},
+        {TSQLP_TOKEN_WHITE_SPACE, " "},
+        {TSQLP_TOKEN_STRING, "'x'"},
+        {TSQLP_TOKEN_WHITE_SPACE, " "},
+        {TSQLP_TOKEN_COMMENT, "-- c"},
+        {TSQLP_TOKEN_WHITE_SPACE, "\n"},
+        {TSQLP_TOKEN_KEYWORD, "FROM"},
+        {TSQLP_TOKEN_WHITE_SPACE, " "},
+        {TSQLP_TOKEN_IDENTIFIER, "`t`"},
+        {TSQLP_TOKEN_WHITE_SPACE, " "},
+        {TSQLP_TOKEN_KEYWORD, "WHERE"},
+        {TSQLP_TOKEN_WHITE_SPACE, " "},
+        {TSQLP_TOKEN_VARIABLE, "@v"},
+        {TSQLP_TOKEN_WHITE_SPACE, " "},
+        {TSQLP_TOKEN_OPERATOR, ">="},
+        {TSQLP_TOKEN_WHITE_SPACE, " "},
+        {TSQLP_TOKEN_PLACEHOLDER, "?"},
+        {TSQLP_TOKEN_WHITE_SPACE, " "},
+        {TSQLP_TOKEN_COMMENT, "#"},
+    };
+    struct tsqlp_tokenizer *tokenizer = tsqlp_tokenizer_new(sql, strlen(sql));
+    struct tsqlp_token token;
+    size_t offset = 0;
+
+    cr_assert_not_null(tokenizer);
+
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        cr_assert_eq(tsqlp_tokenizer_next(tokenizer, &token), 1);
+        cr_assert_eq(token.type, expected[i].type);
+        cr_assert_eq(token.offset, offset);
+        cr_assert_eq(token.len, strlen(expected[i].text));
+        cr_assert_eq(strncmp(sql + token.offset, expected[i].text, token.len), 0);
+
+        offset += token.len;
+    }
+
+    cr_assert_eq(tsqlp_tokenizer_next(tokenizer, &token), 0);
+    cr_assert_eq(tsqlp_tokenizer_next(tokenizer, &token), 0);
+
+    tsqlp_tokenizer_free(tokenizer);
+
+    cr_assert_null(tsqlp_tokenizer_new(NULL, 0));
+}
+
+Test(tsqlp_tokenizer, continues_after_unknown_tokens) {
+    const char *sql = "a ; b";
+    tsqlp_token_type expected[] = {
+        TSQLP_TOKEN_IDENTIFIER, TSQLP_TOKEN_WHITE_SPACE, TSQLP_TOKEN_UNKNOWN, TSQLP_TOKEN_WHITE_SPACE, TSQLP_TOKEN_IDENTIFIER
+    };
+    struct tsqlp_tokenizer *tokenizer = tsqlp_tokenizer_new(sql, strlen(sql));
+    struct tsqlp_token token;
+
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        cr_assert_eq(tsqlp_tokenizer_next(tokenizer, &token), 1);
+        cr_assert_eq(token.type, expected[i]);
+    }
+
+    cr_assert_eq(tsqlp_tokenizer_next(tokenizer, &token), 0);
+
+    tsqlp_tokenizer_free(tokenizer);
+}
+
+#define KEYWORDS_MAX 256
+
+static size_t read_keywords(char words[KEYWORDS_MAX][64]) {
+    FILE *file = fopen(TSQLP_LEXER_HEADER, "rb");
+    static char header[65536];
+
+    cr_assert_not_null(file);
+
+    size_t len = fread(header, 1, sizeof(header) - 1, file);
+
+    fclose(file);
+    header[len] = '\0';
+
+    const char *enum_end = strstr(header, "} sql_token_type;");
+    size_t count = 0;
+
+    for (const char *cursor = strstr(header, "T_K_"); cursor != NULL && cursor < enum_end; cursor = strstr(cursor, "T_K_")) {
+        size_t word_len = strspn(cursor + 4, "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_");
+
+        cr_assert_lt(count, KEYWORDS_MAX);
+        cr_assert_lt(word_len, 64);
+
+        memcpy(words[count], cursor + 4, word_len);
+        words[count][word_len] = '\0';
+        count++;
+        cursor += 4 + word_len;
+    }
+
+    return count;
+}
+
+static sql_token_type lex_word(const char *word) {
+    struct lexer lexer = lexer_new(word, strlen(word));
+    const struct token *token = lexer_peek(&lexer);
+    sql_token_type type = token->len == strlen(word) ? token->type : T_UNKNOWN;
+
+    lexer_destroy(&lexer);
+
+    return type;
+}
+
+static int is_keyword(char words[KEYWORDS_MAX][64], size_t count, const char *word) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcasecmp(words[i], word) == 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+Test(lexer, recognizes_every_keyword_in_any_case) {
+    static char words[KEYWORDS_MAX][64];
+    size_t count = read_keywords(words);
+
+    // Keywords are declared in one run, so the n-th name is T_K_SELECT + n
+    cr_assert_eq(T_K_SELECT + count - 1, T_K_SHARE);
+
+    for (size_t i = 0; i < count; i++) {
+        char word[66];
+        size_t len = strlen(words[i]);
+
+        for (size_t j = 0; j <= len; j++) {
+            word[j] = j % 2 ? (char) tolower(words[i][j]) : words[i][j];
+        }
+
+        cr_assert_eq(lex_word(word), T_K_SELECT + i, "%s", word);
+
+        for (size_t j = 0; j <= len; j++) {
+            word[j] = (char) tolower(words[i][j]);
+        }
+
+        cr_assert_eq(lex_word(word), T_K_SELECT + i, "%s", word);
+
+        if (len > 1) {
+            word[len - 1] = '\0';
+
+            if (!is_keyword(words, count, word)) {
+                cr_assert_eq(lex_word(word), T_IDENTIFIER, "%s", word);
+            }
+        }
+
+        strcpy(word, words[i]);
+        strcat(word, "_");
+
+        if (!is_keyword(words, count, word)) {
+            cr_assert_eq(lex_word(word), T_IDENTIFIER, "%s", word);
+        }
+    }
+}
+
+#ifdef TSQLP_TABLE_SCANNER
+Test(lexer, rejects_words_sharing_a_keyword_slot) {
+    static char words[KEYWORDS_MAX][64];
+    size_t count = read_keywords(words);
+    const char *alphabet = "abcdefghijklmnopqrstuvwxyz0123456789_";
+    size_t collisions = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(words[i]);
+        size_t slot = keyword_slot(words[i], len);
+        size_t varied = len - 1 < 4 ? len - 1 : 4;
+        size_t candidates = 1;
+        char word[64];
+
+        for (size_t j = 0; j < varied; j++) {
+            candidates *= 37;
+        }
+
+        // Words of the same length in the same slot only differ from the keyword in the final comparison
+        for (size_t n = 0; n < candidates; n++) {
+            strcpy(word, words[i]);
+
+            for (size_t j = 0, digits = n; j < varied; j++, digits /= 37) {
+                word[len - 1 - j] = alphabet[digits % 37];
+            }
+
+            if (keyword_slot(word, len) != slot || strcasecmp(word, words[i]) == 0) {
+                continue;
+            }
+
+            cr_assert_eq(lex_word(word), T_IDENTIFIER, "%s shares the slot of %s", word, words[i]);
+            collisions++;
+
+            break;
+        }
+    }
+
+    cr_assert_gt(collisions, count / 2);
+}
+#endif
+
+static void assert_token(const struct token *token, sql_token_type type, size_t position, size_t len) {
+    cr_assert_eq(token->type, type);
+    cr_assert_eq(token->position, position);
+    cr_assert_eq(token->len, len);
+}
+
+Test(lexer, cursor_and_lookahead) {
+    const char *sql = "SELECT a , ?  FROM t";
+    struct lexer lexer = lexer_new(sql, strlen(sql));
+
+#ifdef TSQLP_TOKEN_ARRAY
+    // Whitespace is left out and the final T_EOF is kept
+    cr_assert_eq(lexer.tokens.count, 7);
+#endif
+
+    cr_assert_eq(lexer_has_previous(&lexer), 0);
+    cr_assert_eq(lexer_previous_end(&lexer), 0);
+    cr_assert_eq(lexer_peek_type(&lexer), T_K_SELECT);
+    cr_assert_eq(lexer_peek_position(&lexer), 0);
+    assert_token(lexer_peek_next(&lexer), T_IDENTIFIER, 7, 1);
+    assert_token(lexer_peek(&lexer), T_K_SELECT, 0, 6);
+
+    struct token token = lexer_consume(&lexer);
+
+    assert_token(&token, T_K_SELECT, 0, 6);
+    cr_assert_eq(lexer_has_previous(&lexer), 1);
+    assert_token(lexer_peek_previous(&lexer), T_K_SELECT, 0, 6);
+    cr_assert_eq(lexer_previous_end(&lexer), 6);
+    assert_token(lexer_peek(&lexer), T_IDENTIFIER, 7, 1);
+    assert_token(lexer_peek_next(&lexer), T_COMMA, 9, 1);
+
+    lexer_skip(&lexer);
+
+    cr_assert_eq(lexer_tokens_consumed(&lexer), 2);
+    assert_token(lexer_peek_previous(&lexer), T_IDENTIFIER, 7, 1);
+    cr_assert_eq(lexer_previous_end(&lexer), 8);
+    cr_assert_eq(lexer_peek_type(&lexer), T_COMMA);
+    cr_assert_eq(lexer_peek_position(&lexer), 9);
+    assert_token(lexer_peek_next(&lexer), T_PLACEHOLDER, 11, 1);
+
+    lexer_skip(&lexer);
+    lexer_skip(&lexer);
+
+    assert_token(lexer_peek(&lexer), T_K_FROM, 14, 4);
+    assert_token(lexer_peek_previous(&lexer), T_PLACEHOLDER, 11, 1);
+    assert_token(lexer_peek_next(&lexer), T_IDENTIFIER, 19, 1);
+
+    lexer_skip(&lexer);
+    lexer_skip(&lexer);
+
+    cr_assert_eq(lexer_has(&lexer), 0);
+    cr_assert_eq(lexer_peek_type(&lexer), T_EOF);
+    cr_assert_eq(lexer_peek_position(&lexer), 20);
+    assert_token(lexer_peek_next(&lexer), T_EOF, 20, 0);
+    cr_assert_eq(lexer_previous_end(&lexer), 20);
+
+    // Consuming past the end keeps returning the final token
+    token = lexer_consume(&lexer);
+
+    cr_assert_eq(token.type, T_EOF);
+    cr_assert_eq(lexer_peek_type(&lexer), T_EOF);
+    cr_assert_eq(lexer_peek(&lexer)->type, T_EOF);
+
+    lexer_destroy(&lexer);
+}
+
+Test(lexer, stops_at_an_unknown_token) {
+    const char *sql = "a ; b";
+    struct lexer lexer = lexer_new(sql, strlen(sql));
+
+    lexer_skip(&lexer);
+
+    assert_token(lexer_peek(&lexer), T_UNKNOWN, 2, 1);
+    cr_assert_eq(lexer_peek_next(&lexer)->type, T_UNKNOWN);
+
+    lexer_skip(&lexer);
+
+    cr_assert_eq(lexer_peek_type(&lexer), T_UNKNOWN);
+
+    lexer_destroy(&lexer);
+}
+
+Test(lexer, reset_starts_over_on_another_query) {
+    const char *first = "SELECT /*+ BKA(t) */ a";
+    char second[512] = "SELECT ?";
+    struct lexer lexer = lexer_new(first, strlen(first));
+
+    lexer_skip(&lexer);
+    lexer_skip(&lexer);
+
+    cr_assert_eq(lexer_hints(&lexer)->count, 1);
+
+    // More tokens than the array of the first query has room for
+    for (size_t i = 0; i < 200; i++) {
+        strcat(second, ",?");
+    }
+
+    lexer_reset(&lexer, second, strlen(second));
+
+    cr_assert_eq(lexer_hints(&lexer)->count, 0);
+    cr_assert_eq(lexer_tokens_consumed(&lexer), 0);
+    cr_assert_eq(lexer_has_previous(&lexer), 0);
+    cr_assert_eq(lexer_previous_end(&lexer), 0);
+    assert_token(lexer_peek(&lexer), T_K_SELECT, 0, 6);
+    assert_token(lexer_peek_next(&lexer), T_PLACEHOLDER, 7, 1);
+
+    lexer_skip(&lexer);
+
+    for (size_t i = 0; i < 200; i++) {
+        assert_token(lexer_peek(&lexer), T_PLACEHOLDER, 7 + 2 * i, 1);
+        lexer_skip(&lexer);
+        assert_token(lexer_peek(&lexer), T_COMMA, 8 + 2 * i, 1);
+        lexer_skip(&lexer);
+    }
+
+    assert_token(lexer_peek(&lexer), T_PLACEHOLDER, 407, 1);
+    assert_token(lexer_peek_previous(&lexer), T_COMMA, 406, 1);
+    assert_token(lexer_peek_next(&lexer), T_EOF, 408, 0);
+
+    lexer_reset(&lexer, first, strlen(first));
+
+    assert_token(lexer_peek(&lexer), T_K_SELECT, 0, 6);
+    assert_token(lexer_peek_next(&lexer), T_IDENTIFIER, 21, 1);
+    cr_assert_eq(lexer_hints(&lexer)->count, 1);
+
+    lexer_destroy(&lexer);
+}
+
+// Marks has one character per byte of the statement, the bit of every byte not marked with a space must be set
+static void assert_bitmap(const uint64_t *bitmap, const char *marks) {
+    size_t len = strlen(marks);
+
+    for (size_t i = 0; i < len; i++) {
+        cr_assert_eq((bitmap[i / 64] >> (i % 64)) & 1, marks[i] != ' ', "bit %zu", i);
+    }
+
+    cr_assert_eq(structural_index_count(bitmap, len, (len / 64 + 1) * 64), 0);
+}
+
+Test(structural_index, escaped_quotes) {
+    const char *sql          = "'a\\'b', \"c\\\"d\", 'e''f', `g\\`, ?";
+    const char *strings      = "xxxxxx  xxxxxx  xxxxxx         ";
+    const char *backticks    = "                        xxxx   ";
+    const char *commas       = "      x       x       x     x  ";
+    const char *placeholders = "                              x";
+    struct structural_index structural_index = structural_index_new(sql, strlen(sql));
+
+    assert_bitmap(structural_index.strings, strings);
+    assert_bitmap(structural_index.backticks, backticks);
+    assert_bitmap(structural_index.commas, commas);
+    assert_bitmap(structural_index.placeholders, placeholders);
+
+    structural_index_destroy(&structural_index);
+}
+
+Test(structural_index, quotes_in_comments) {
+    const char *sql          = "# it's ?\n? /* \"? */, -- `(\n) 'x#' ?";
+    const char *comments     = "xxxxxxxx   xxxxxxxx  xxxxx         ";
+    const char *strings      = "                             xxxx  ";
+    const char *commas       = "                   x               ";
+    const char *placeholders = "         x                        x";
+    const char *close_parens = "                           x       ";
+    struct structural_index structural_index = structural_index_new(sql, strlen(sql));
+
+    assert_bitmap(structural_index.comments, comments);
+    assert_bitmap(structural_index.strings, strings);
+    assert_bitmap(structural_index.backticks, "");
+    assert_bitmap(structural_index.commas, commas);
+    assert_bitmap(structural_index.placeholders, placeholders);
+    assert_bitmap(structural_index.close_parens, close_parens);
+    assert_bitmap(structural_index.open_parens, "");
+
+    structural_index_destroy(&structural_index);
+}
+
+Test(structural_index, unterminated_literals_run_to_the_end) {
+    struct {
+        const char *sql;
+        size_t strings;
+        size_t backticks;
+        size_t comments;
+    } statements[] = {
+        {"? 'a, (?)", 7, 0, 0},
+        {"? \"a\\\", ?", 7, 0, 0},
+        {"? `a, ?", 0, 5, 0},
+        {"? /* a, ?", 0, 0, 7},
+    };
+
+    for (size_t i = 0; i < sizeof(statements) / sizeof(statements[0]); i++) {
+        const char *sql = statements[i].sql;
+        size_t len = strlen(sql);
+        struct structural_index structural_index = structural_index_new(sql, len);
+
+        cr_assert_eq(structural_index_count(structural_index.strings, 0, len), statements[i].strings, "%s", sql);
+        cr_assert_eq(structural_index_count(structural_index.backticks, 0, len), statements[i].backticks, "%s", sql);
+        cr_assert_eq(structural_index_count(structural_index.comments, 0, len), statements[i].comments, "%s", sql);
+        cr_assert_eq(structural_index_count(structural_index.placeholders, 0, len), 1, "%s", sql);
+        cr_assert_eq(structural_index_count(structural_index.commas, 0, len), 0, "%s", sql);
+        cr_assert_eq(structural_index_count(structural_index.open_parens, 0, len), 0, "%s", sql);
+
+        structural_index_destroy(&structural_index);
+    }
+}
+
+Test(structural_index, regions_crossing_words) {
+    char sql[200];
+    char strings[200];
+    char comments[200];
+    char placeholders[200];
+
+    memset(sql, ' ', sizeof(sql));
+    memset(strings, ' ', sizeof(strings));
+    memset(comments, ' ', sizeof(comments));
+    memset(placeholders, ' ', sizeof(placeholders));
+
+    // String from 60 to 70 with an escape at the word edge, so the quote at 64 does not close it
+    sql[60] = '\'';
+    sql[62] = '?';
+    sql[63] = '\\';
+    sql[64] = '\'';
+    sql[66] = ',';
+    sql[70] = '\'';
+    memset(strings + 60, 'x', 11);
+    sql[71] = '?';
+    placeholders[71] = 'x';
+
+    // Comment from 120 to 193, covering a whole word, and a placeholder right after it
+    memcpy(sql + 120, "/*", 2);
+    sql[127] = '?';
+    sql[128] = '\'';
+    sql[191] = '?';
+    memcpy(sql + 192, "*/", 2);
+    memset(comments + 120, 'x', 74);
+    sql[194] = '?';
+    placeholders[194] = 'x';
+
+    sql[195] = '\0';
+    strings[195] = '\0';
+    comments[195] = '\0';
+    placeholders[195] = '\0';
+
+    struct structural_index structural_index = structural_index_new(sql, strlen(sql));
+
+    cr_assert_eq(structural_index.words, 4);
+    assert_bitmap(structural_index.strings, strings);
+    assert_bitmap(structural_index.comments, comments);
+    assert_bitmap(structural_index.placeholders, placeholders);
+    assert_bitmap(structural_index.commas, "");
+
+    // Another statement reuses the bitmaps and must not see the previous regions
+    structural_index_rebuild(&structural_index, "? '?'", 5);
+
+    cr_assert_eq(structural_index.words, 1);
+    assert_bitmap(structural_index.strings, "  xxx");
+    assert_bitmap(structural_index.comments, "");
+    assert_bitmap(structural_index.placeholders, "x");
+
+    structural_index_destroy(&structural_index);
+}
+
+Test(structural_index, count_and_next_at_word_edges) {
+    uint64_t bitmap[4] = {0};
+    size_t bits[] = {0, 63, 64, 127, 128, 191};
+
+    for (size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); i++) {
+        bitmap[bits[i] / 64] |= (uint64_t) 1 << (bits[i] % 64);
+    }
+
+    cr_assert_eq(structural_index_count(bitmap, 0, 0), 0);
+    cr_assert_eq(structural_index_count(bitmap, 64, 63), 0);
+    cr_assert_eq(structural_index_count(bitmap, 0, 1), 1);
+    cr_assert_eq(structural_index_count(bitmap, 1, 63), 0);
+    cr_assert_eq(structural_index_count(bitmap, 0, 64), 2);
+    cr_assert_eq(structural_index_count(bitmap, 63, 65), 2);
+    cr_assert_eq(structural_index_count(bitmap, 64, 128), 2);
+    cr_assert_eq(structural_index_count(bitmap, 64, 129), 3);
+    cr_assert_eq(structural_index_count(bitmap, 65, 127), 0);
+    cr_assert_eq(structural_index_count(bitmap, 0, 256), 6);
+    cr_assert_eq(structural_index_count(bitmap, 192, 256), 0);
+
+    cr_assert_eq(structural_index_next(bitmap, 0, 0), 0);
+    cr_assert_eq(structural_index_next(bitmap, 0, 200), 0);
+    cr_assert_eq(structural_index_next(bitmap, 1, 200), 63);
+    cr_assert_eq(structural_index_next(bitmap, 1, 63), 63);
+    cr_assert_eq(structural_index_next(bitmap, 64, 200), 64);
+    cr_assert_eq(structural_index_next(bitmap, 65, 127), 127);
+    cr_assert_eq(structural_index_next(bitmap, 65, 128), 127);
+    cr_assert_eq(structural_index_next(bitmap, 129, 191), 191);
+    cr_assert_eq(structural_index_next(bitmap, 129, 192), 191);
+    cr_assert_eq(structural_index_next(bitmap, 192, 256), 256);
+}
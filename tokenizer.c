@@ -0,0 +1,117 @@
+#include <stdlib.h>
+
+#include "lexer.h"
+#include "tsqlp.h"
+
+extern void *lexer_use_buffer(const char *buff, size_t len);
+
+extern void lexer_clear_buffer(void *scanner);
+
+struct tsqlp_tokenizer {
+    void *scanner;
+    int is_done;
+};
+
+tsqlp_token_type tsqlp_token_type_from(sql_token_type type) {
+    switch (type) {
+        case T_WHITE_SPACE:
+            return TSQLP_TOKEN_WHITE_SPACE;
+        case T_COMMENT:
+            return TSQLP_TOKEN_COMMENT;
+        case T_OPTIMIZER_HINT:
+            return TSQLP_TOKEN_OPTIMIZER_HINT;
+        case T_IDENTIFIER:
+            return TSQLP_TOKEN_IDENTIFIER;
+        case T_QUALIFIED_IDENTIFIER:
+            return TSQLP_TOKEN_QUALIFIED_IDENTIFIER;
+        case T_WILDCARD_IDENTIFIER:
+            return TSQLP_TOKEN_WILDCARD_IDENTIFIER;
+        case T_VARIABLE:
+            return TSQLP_TOKEN_VARIABLE;
+        case T_STRING:
+            return TSQLP_TOKEN_STRING;
+        case T_NUMBER:
+            return TSQLP_TOKEN_NUMBER;
+        case T_HEX_VALUE:
+            return TSQLP_TOKEN_HEX_VALUE;
+        case T_BIT_VALUE:
+            return TSQLP_TOKEN_BIT_VALUE;
+        case T_PLACEHOLDER:
+            return TSQLP_TOKEN_PLACEHOLDER;
+        case T_COMMA:
+            return TSQLP_TOKEN_COMMA;
+        case T_OPEN_PAREN:
+            return TSQLP_TOKEN_OPEN_PAREN;
+        case T_CLOSE_PAREN:
+            return TSQLP_TOKEN_CLOSE_PAREN;
+        case T_PLUS:
+        case T_MINUS:
+        case T_BIT_NOT:
+        case T_NOT:
+        case T_MULT:
+        case T_BIT_OR:
+        case T_BIT_AND:
+        case T_LEFT_SHIFT:
+        case T_RIGHT_SHIFT:
+        case T_DIV:
+        case T_MOD:
+        case T_BIT_XOR:
+        case T_OR:
+        case T_AND:
+        case T_ARROW:
+        case T_COMPARISON_OPERATOR:
+            return TSQLP_TOKEN_OPERATOR;
+        case T_EOF:
+            // intentional
+        case T_UNKNOWN:
+            return TSQLP_TOKEN_UNKNOWN;
+        default:
+            // Interval units and T_K_* keywords
+            return TSQLP_TOKEN_KEYWORD;
+    }
+}
+
+struct tsqlp_tokenizer *tsqlp_tokenizer_new(const char *sql, size_t len) {
+    if (sql == NULL) {
+        return NULL;
+    }
+
+    struct tsqlp_tokenizer *tokenizer = (struct tsqlp_tokenizer *) malloc(sizeof(struct tsqlp_tokenizer));
+
+    if (tokenizer == NULL) {
+        return NULL;
+    }
+
+    tokenizer->scanner = lexer_use_buffer(sql, len);
+    tokenizer->is_done = 0;
+
+    return tokenizer;
+}
+
+int tsqlp_tokenizer_next(struct tsqlp_tokenizer *tokenizer, struct tsqlp_token *token) {
+    if (tokenizer->is_done) {
+        return 0;
+    }
+
+    struct token next = lexer_lex(tokenizer->scanner);
+
+    if (token_is_of_type(T_EOF, &next)) {
+        tokenizer->is_done = 1;
+
+        return 0;
+    }
+
+    *token = (struct tsqlp_token) {
+        .type = tsqlp_token_type_from(token_type(&next)),
+        .offset = token_position(&next),
+        .len = token_length(&next)
+    };
+
+    return 1;
+}
+
+void tsqlp_tokenizer_free(struct tsqlp_tokenizer *tokenizer) {
+    lexer_clear_buffer(tokenizer->scanner);
+
+    free(tokenizer);
+}
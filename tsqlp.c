@@ -1,10 +1,61 @@
+#include "arena.h"
 #include "lexer.h"
+#include "structural_index.h"
 #include "tsqlp.h"
+#include "utf8.h"
+
+struct ast_nodes {
+    struct tsqlp_ast_node *items;
+    size_t count;
+    size_t capacity;
+};
 
 struct parse_state {
-    struct tsqlp_placeholders placeholders;
+    struct tsqlp_arena *arena;
+    int use_views;
+    /*
+     * Placeholder locations of the whole parse, every section gets a slice starting at section_start. Locations are
+     * relative to pool_offset, the offset of the outermost section being tracked.
+     */
+    struct tsqlp_placeholder_pool pool;
+    size_t pool_offset;
+    size_t section_start;
+    // Expressions and statements being parsed, each of them holding a few frames of the C stack
+    unsigned int depth;
+    unsigned int max_depth;
+    // Section of the statement being parsed, subqueries save and restore it around their own sections
     int is_tracking_in_progress;
     size_t section_offset;
+    // Sections being tracked by the statement and the statements it is nested in
+    unsigned int sections_in_progress;
+    // Requested TSQLP_SECTION_* flags, and those of them which the top level statement did not get to yet
+    unsigned int sections;
+    unsigned int sections_pending;
+    // Sections being parsed without being tracked, because they or a section enclosing them were not requested
+    unsigned int skipped_sections;
+    // Top level statement stopped after the last requested section, its remainder is not parsed
+    int has_stopped_early;
+    // Placeholders of the statement and its subqueries, whether their sections are tracked or not
+    size_t placeholder_count;
+    // Callback of tsqlp_parse_events(), NULL for other parses
+    tsqlp_event_callback callback;
+    void *user_data;
+    // Statements being parsed and the section holding the events, only followed when there is a callback
+    unsigned int statements;
+    unsigned int event_section;
+    // Start of the section being parsed, not reported until it turns out not to be empty
+    int has_pending_section_start;
+    size_t pending_section_offset;
+    /*
+     * Nodes of tsqlp_parse_result_set_ast(), only built when has_ast is set. Nodes are pushed on the stack and moved,
+     * next to their siblings, to the nodes of the AST once their parent is done.
+     */
+    int has_ast;
+    struct ast_nodes ast_stack;
+    struct ast_nodes ast_nodes;
+#ifdef TSQLP_STRUCTURAL_INDEX
+    const struct structural_index *structural_index;
+#endif
 };
 
 typedef enum {
@@ -65,16 +116,10 @@ parse_joined_table(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
 static tsqlp_parse_status
 parse_table_factor(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state);
 
-static tsqlp_parse_status
-parse_arithm_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state);
-
-static tsqlp_parse_status
-parse_predicate_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state);
-
 static tsqlp_parse_status
 parse_simple_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state);
 
-static tsqlp_parse_status parse_alias(struct lexer *lexer);
+static tsqlp_parse_status parse_alias(struct lexer *lexer, struct parse_state *parse_state);
 
 static tsqlp_parse_status
 parse_join_specification(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state,
@@ -90,21 +135,57 @@ typedef enum {
     STARTED_TRACKING_PLACEHOLDERS
 } parse_state_type;
 
-struct parse_state parse_state_new();
+struct parse_state
+parse_state_new(struct tsqlp_arena *arena, int use_views, unsigned int max_depth, unsigned int sections);
 
 parse_state_type parse_state_start_counting(struct parse_state *parse_state, size_t section_offset);
 
-void parse_state_register_placeholder(struct parse_state *parse_state, size_t location);
+tsqlp_parse_status parse_state_register_placeholder(struct parse_state *parse_state, const struct token *token);
+
+static tsqlp_parse_status
+parse_state_emit_token(struct parse_state *parse_state, tsqlp_event_type type, const struct token *token);
+
+static void parse_state_ast_leaf(struct parse_state *parse_state, tsqlp_ast_node_type type, const struct token *token);
 
-struct tsqlp_placeholders parse_state_finish_counting(struct parse_state *parse_state);
+struct tsqlp_placeholders parse_state_finish_counting(struct parse_state *parse_state, size_t section_end);
 
 
 
-struct parse_state parse_state_new() {
+struct parse_state
+parse_state_new(struct tsqlp_arena *arena, int use_views, unsigned int max_depth, unsigned int sections) {
     return (struct parse_state) {
-        .placeholders =  tsqlp_placeholders_new(),
+        .arena = arena,
+        .use_views = use_views,
+        .depth = 0,
+        .max_depth = max_depth,
+        .pool = tsqlp_placeholder_pool_new(),
+        .pool_offset = 0,
+        .section_start = 0,
         .section_offset = 0,
-        .is_tracking_in_progress = 0
+        .is_tracking_in_progress = 0,
+        .sections_in_progress = 0,
+        .sections = sections,
+        .sections_pending = sections,
+        .skipped_sections = 0,
+        .has_stopped_early = 0,
+        .placeholder_count = 0,
+        .callback = NULL,
+        .user_data = NULL,
+        .statements = 0,
+        .event_section = 0,
+        .has_pending_section_start = 0,
+        .pending_section_offset = 0,
+        .has_ast = 0,
+        .ast_stack = {
+            .items = NULL,
+            .count = 0,
+            .capacity = 0
+        },
+        .ast_nodes = {
+            .items = NULL,
+            .count = 0,
+            .capacity = 0
+        }
     };
 }
 
@@ -113,18 +194,103 @@ parse_state_type parse_state_start_counting(struct parse_state *parse_state, siz
         return STILL_TRACKING_PLACEHOLDERS;
     }
 
+    if (parse_state->sections_in_progress++ == 0) {
+        parse_state->pool_offset = section_offset;
+    }
+
     parse_state->is_tracking_in_progress = 1;
-    parse_state->placeholders = tsqlp_placeholders_new();
+    parse_state->section_start = parse_state->pool.count;
     parse_state->section_offset = section_offset;
 
     return STARTED_TRACKING_PLACEHOLDERS;
 }
 
-void parse_state_register_placeholder(struct parse_state *parse_state, size_t location) {
-    tsqlp_placeholders_push(&parse_state->placeholders, location - parse_state->section_offset);
+#define PLACEHOLDER_POOL_INITIAL_CAPACITY 16
+
+struct tsqlp_placeholder_pool tsqlp_placeholder_pool_new() {
+    return (struct tsqlp_placeholder_pool) {
+        .locations = NULL,
+        .count = 0,
+        .capacity = 0
+    };
+}
+
+void tsqlp_placeholder_pool_reserve(struct tsqlp_placeholder_pool *pool, size_t count, struct tsqlp_arena *arena) {
+    if (pool->count + count <= pool->capacity) {
+        return;
+    }
+
+    size_t capacity = pool->capacity > 0 ? pool->capacity * 2 : PLACEHOLDER_POOL_INITIAL_CAPACITY;
+
+    while (capacity < pool->count + count) {
+        capacity *= 2;
+    }
+
+    pool->locations = (size_t *) tsqlp_arena_grow(
+        arena,
+        pool->locations,
+        pool->count * sizeof(size_t),
+        capacity * sizeof(size_t)
+    );
+    pool->capacity = capacity;
+}
+
+struct tsqlp_placeholders tsqlp_placeholder_pool_slice(const struct tsqlp_placeholder_pool *pool, size_t start) {
+    size_t count = pool->count - start;
+
+    return (struct tsqlp_placeholders) {
+        .locations = count > 0 ? pool->locations + start : NULL,
+        .count = count
+    };
+}
+
+tsqlp_parse_status parse_state_register_placeholder(struct parse_state *parse_state, const struct token *token) {
+    parse_state->placeholder_count++;
+
+    /*
+     * Placeholders are read from the structural index once the section is finished. Without it they are kept unless
+     * they are not inside any tracked section, which only happens in statements of skipped sections.
+     */
+#ifndef TSQLP_STRUCTURAL_INDEX
+    if (parse_state->sections_in_progress > 0) {
+        tsqlp_placeholder_pool_reserve(&parse_state->pool, 1, parse_state->arena);
+
+        parse_state->pool.locations[parse_state->pool.count++] = token_position(token) - parse_state->pool_offset;
+    }
+#endif
+
+    parse_state_ast_leaf(parse_state, TSQLP_AST_PLACEHOLDER, token);
+
+    return parse_state_emit_token(parse_state, TSQLP_EVENT_PLACEHOLDER, token);
+}
+
+#ifdef TSQLP_STRUCTURAL_INDEX
+
+/*
+ * Every "?" outside of literals is a placeholder token, so the section placeholders are the ones in the placeholder
+ * bitmap between the section start and end
+ */
+static void parse_state_index_placeholders(struct parse_state *parse_state, size_t section_end) {
+    const uint64_t *bitmap = parse_state->structural_index->placeholders;
+
+    tsqlp_placeholder_pool_reserve(
+        &parse_state->pool,
+        structural_index_count(bitmap, parse_state->section_offset, section_end),
+        parse_state->arena
+    );
+
+    for (
+        size_t location = structural_index_next(bitmap, parse_state->section_offset, section_end);
+        location < section_end;
+        location = structural_index_next(bitmap, location + 1, section_end)
+    ) {
+        parse_state->pool.locations[parse_state->pool.count++] = location - parse_state->section_offset;
+    }
 }
 
-struct tsqlp_placeholders parse_state_finish_counting(struct parse_state *parse_state) {
+#endif
+
+struct tsqlp_placeholders parse_state_finish_counting(struct parse_state *parse_state, size_t section_end) {
     if (!parse_state->is_tracking_in_progress) {
         return (struct tsqlp_placeholders) {
             .locations = NULL,
@@ -134,7 +300,41 @@ struct tsqlp_placeholders parse_state_finish_counting(struct parse_state *parse_
 
     parse_state->is_tracking_in_progress = 0;
 
-    return parse_state->placeholders;
+#ifdef TSQLP_STRUCTURAL_INDEX
+    parse_state_index_placeholders(parse_state, section_end);
+#else
+    (void) section_end;
+#endif
+
+    size_t count = parse_state->pool.count - parse_state->section_start;
+
+    if (--parse_state->sections_in_progress == 0 || count == 0) {
+        return tsqlp_placeholder_pool_slice(&parse_state->pool, parse_state->section_start);
+    }
+
+    /*
+     * Section of a subquery, whose placeholders also belong to the section of the enclosing statement. They are copied
+     * relative to the subquery section, and the pool keeps them for the enclosing section unless they are read from
+     * the structural index again when it finishes.
+     */
+    size_t *locations = (size_t *) tsqlp_arena_alloc(parse_state->arena, count * sizeof(size_t));
+
+#ifdef TSQLP_STRUCTURAL_INDEX
+    memcpy(locations, parse_state->pool.locations + parse_state->section_start, count * sizeof(size_t));
+
+    parse_state->pool.count = parse_state->section_start;
+#else
+    size_t delta = parse_state->section_offset - parse_state->pool_offset;
+
+    for (size_t i = 0; i < count; i++) {
+        locations[i] = parse_state->pool.locations[parse_state->section_start + i] - delta;
+    }
+#endif
+
+    return (struct tsqlp_placeholders) {
+        .locations = locations,
+        .count = count
+    };
 }
 
 #define RETURN_IF_NOT_OK(expr) \
@@ -146,236 +346,610 @@ struct tsqlp_placeholders parse_state_finish_counting(struct parse_state *parse_
     } while (0)
 #define RETURN_ERROR_IF_TOKEN_NOT(type, lexer) \
     do { \
-        if (!token_is_of_type(type, lexer_peek(lexer))) { \
+        if (lexer_peek_type(lexer) != type) { \
+            lexer_set_expected(lexer, type); \
             return TSQLP_PARSE_INVALID_SYNTAX; \
         } \
-        lexer_consume(lexer); \
+        lexer_skip(lexer); \
     } while (0)
 #define RETURN_SUCCESS_IF_TOKEN_NOT(type, lexer) \
     do { \
-        if (!token_is_of_type(type, lexer_peek(lexer))) { \
+        if (lexer_peek_type(lexer) != type) { \
             return TSQLP_PARSE_OK; \
         } \
-        lexer_consume(lexer); \
+        lexer_skip(lexer); \
     } while (0)
 #define CONSUME_IF_TOKEN(type, lexer) \
     do { \
-        if (token_is_of_type(type, lexer_peek(lexer))) { \
-            lexer_consume(lexer); \
+        if (lexer_peek_type(lexer) == type) { \
+            lexer_skip(lexer); \
         } \
     } while (0)
 
-#define TRACK_SECTION(section, lexer, parse_result, parse_state, call) \
-    do { \
-        size_t position = token_position(lexer_peek(lexer)); \
-        int is_top_level = parse_state_start_counting(parse_state, position) == STARTED_TRACKING_PLACEHOLDERS; \
-        size_t tokens_consumed = lexer_tokens_consumed(lexer); \
-        \
-        tsqlp_parse_status status = call; \
-        \
-        if (is_top_level) { \
-            struct tsqlp_placeholders tsqlp_placeholders = parse_state_finish_counting(parse_state); \
-            \
-            if (tokens_consumed < lexer_tokens_consumed(lexer)) { \
-                tsqlp_sql_section_update( \
-                    lexer_buffer(lexer) + position, \
-                    token_position(lexer_peek_previous(lexer)) + token_length(lexer_peek_previous(lexer)) - position, \
-                    tsqlp_placeholders, \
-                    &parse_result->section \
-                ); \
-            } \
-        } \
-        \
-        return status; \
-    } while (0)
+static tsqlp_parse_status
+parse_state_emit(struct parse_state *parse_state, tsqlp_event_type type, struct tsqlp_token token) {
+    if (parse_state->callback == NULL) {
+        return TSQLP_PARSE_OK;
+    }
+
+    if (parse_state->has_pending_section_start) {
+        parse_state->has_pending_section_start = 0;
+
+        RETURN_IF_NOT_OK(parse_state_emit(parse_state, TSQLP_EVENT_SECTION_START, (struct tsqlp_token) {
+            .type = TSQLP_TOKEN_UNKNOWN,
+            .offset = parse_state->pending_section_offset,
+            .len = 0
+        }));
+    }
+
+    struct tsqlp_event event = {
+        .type = type,
+        .section = parse_state->event_section,
+        .depth = parse_state->statements - 1,
+        .token = token
+    };
+
+    return parse_state->callback(&event, parse_state->user_data) == 0 ? TSQLP_PARSE_OK : TSQLP_PARSE_ABORTED;
+}
 
 static tsqlp_parse_status
-parse_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    RETURN_IF_NOT_OK(parse_predicate_expression(lexer, parse_result, parse_state));
+parse_state_emit_token(struct parse_state *parse_state, tsqlp_event_type type, const struct token *token) {
+    if (parse_state->callback == NULL) {
+        return TSQLP_PARSE_OK;
+    }
+
+    return parse_state_emit(parse_state, type, (struct tsqlp_token) {
+        .type = tsqlp_token_type_from(token_type(token)),
+        .offset = token_position(token),
+        .len = token_length(token)
+    });
+}
 
-    switch (token_type(lexer_peek(lexer))) {
-        case T_K_XOR:
+/*
+ * Operand of an expression, reported as an identifier or a literal
+ */
+static tsqlp_parse_status parse_state_emit_operand(struct parse_state *parse_state, const struct token *token) {
+    switch (token_type(token)) {
+        case T_IDENTIFIER:
+            // intentional
+        case T_QUALIFIED_IDENTIFIER:
+            // intentional
+        case T_WILDCARD_IDENTIFIER:
+            return parse_state_emit_token(parse_state, TSQLP_EVENT_IDENTIFIER, token);
+        case T_NUMBER:
+            // intentional
+        case T_BIT_VALUE:
             // intentional
-        case T_AND:
+        case T_HEX_VALUE:
             // intentional
-        case T_K_AND:
+        case T_STRING:
             // intentional
-        case T_K_OR:
+        case T_K_TRUE:
             // intentional
-        case T_ARROW:
+        case T_K_FALSE:
             // intentional
-        case T_OR:
-            lexer_consume(lexer);
+        case T_K_NULL:
+            return parse_state_emit_token(parse_state, TSQLP_EVENT_LITERAL, token);
+        default:
+            return TSQLP_PARSE_OK;
+    }
+}
 
-            return parse_expression(lexer, parse_result, parse_state);
-        case T_COMPARISON_OPERATOR:
-            lexer_consume(lexer);
+static void parse_state_start_section_events(struct parse_state *parse_state, unsigned int section, size_t offset) {
+    parse_state->event_section = section;
+    parse_state->has_pending_section_start = 1;
+    parse_state->pending_section_offset = offset;
+}
 
-            if (token_is_of_type(T_K_ALL, lexer_peek(lexer)) || token_is_of_type(T_K_ANY, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+static tsqlp_parse_status parse_state_finish_section_events(struct parse_state *parse_state, struct lexer *lexer,
+                                                            size_t offset, size_t tokens_consumed) {
+    if (tokens_consumed == lexer_tokens_consumed(lexer)) {
+        // Nothing was reported for an empty section, not even its start
+        parse_state->has_pending_section_start = 0;
 
-                RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
-                RETURN_IF_NOT_OK(parse_stmt(lexer, parse_result, parse_state));
-                RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
+        return TSQLP_PARSE_OK;
+    }
 
-                return TSQLP_PARSE_OK;
-            }
+    return parse_state_emit(parse_state, TSQLP_EVENT_SECTION_END, (struct tsqlp_token) {
+        .type = TSQLP_TOKEN_UNKNOWN,
+        .offset = offset,
+        .len = lexer_previous_end(lexer) - offset
+    });
+}
 
-            return parse_expression(lexer, parse_result, parse_state);
-        case T_K_IS:
-            lexer_consume(lexer);
+#define AST_NODES_INITIAL_CAPACITY 16
 
-            if (token_is_of_type(T_K_NOT, lexer_peek(lexer))) {
-                lexer_consume(lexer);
-            }
+static void ast_nodes_reserve(struct ast_nodes *nodes, size_t count, struct tsqlp_arena *arena) {
+    if (nodes->count + count <= nodes->capacity) {
+        return;
+    }
 
-            const struct token *token = lexer_peek(lexer);
+    size_t capacity = nodes->capacity > 0 ? nodes->capacity * 2 : AST_NODES_INITIAL_CAPACITY;
 
-            if (
-                token_is_of_type(T_K_UNKNOWN, token)
-                || token_is_of_type(T_K_NULL, token)
-                || token_is_of_type(T_K_TRUE, token)
-                || token_is_of_type(T_K_FALSE, token)
-                ) {
-                lexer_consume(lexer);
+    while (capacity < nodes->count + count) {
+        capacity *= 2;
+    }
 
-                return TSQLP_PARSE_OK;
-            }
+    nodes->items = (struct tsqlp_ast_node *) tsqlp_arena_grow(
+        arena,
+        nodes->items,
+        nodes->count * sizeof(struct tsqlp_ast_node),
+        capacity * sizeof(struct tsqlp_ast_node)
+    );
+    nodes->capacity = capacity;
+}
 
-            return TSQLP_PARSE_INVALID_SYNTAX;
+static void parse_state_ast_push(struct parse_state *parse_state, struct tsqlp_ast_node node) {
+    ast_nodes_reserve(&parse_state->ast_stack, 1, parse_state->arena);
+
+    parse_state->ast_stack.items[parse_state->ast_stack.count++] = node;
+}
+
+// Start of the node about to be parsed, only looked up when the AST is built
+static size_t parse_state_ast_offset(const struct parse_state *parse_state, struct lexer *lexer) {
+    return parse_state->has_ast ? lexer_peek_position(lexer) : 0;
+}
+
+// Position on the stack where the children of the node being parsed start
+static size_t parse_state_ast_mark(const struct parse_state *parse_state) {
+    return parse_state->ast_stack.count;
+}
+
+static void parse_state_ast_leaf(struct parse_state *parse_state, tsqlp_ast_node_type type, const struct token *token) {
+    if (!parse_state->has_ast) {
+        return;
+    }
+
+    parse_state_ast_push(parse_state, (struct tsqlp_ast_node) {
+        .type = type,
+        .section = 0,
+        .offset = token_position(token),
+        .len = token_length(token),
+        .first_child = 0,
+        .child_count = 0
+    });
+}
+
+// Operand of an expression, which is not a placeholder
+static void parse_state_ast_operand(struct parse_state *parse_state, const struct token *token) {
+    switch (token_type(token)) {
+        case T_VARIABLE:
+            parse_state_ast_leaf(parse_state, TSQLP_AST_VARIABLE, token);
+            break;
+        case T_MULT:
+            // intentional
+        case T_QUALIFIED_IDENTIFIER:
+            // intentional
+        case T_WILDCARD_IDENTIFIER:
+            parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, token);
+            break;
         default:
-            return TSQLP_PARSE_OK;
+            parse_state_ast_leaf(parse_state, TSQLP_AST_LITERAL, token);
+            break;
     }
 }
 
-static tsqlp_parse_status
-parse_predicate_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    RETURN_IF_NOT_OK(parse_arithm_expression(lexer, parse_result, parse_state));
+/*
+ * Node from offset to the end of the last token consumed, whose children are the nodes pushed since mark. They are
+ * complete, so they are moved to the AST and the node takes their place on the stack.
+ */
+static void parse_state_ast_close(struct parse_state *parse_state, const struct lexer *lexer, tsqlp_ast_node_type type,
+                                  size_t offset, size_t mark) {
+    if (!parse_state->has_ast) {
+        return;
+    }
 
-    if (token_is_of_type(T_K_SOUNDS, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    struct ast_nodes *stack = &parse_state->ast_stack;
+    struct ast_nodes *nodes = &parse_state->ast_nodes;
+    size_t child_count = stack->count - mark;
+    struct tsqlp_ast_node node = {
+        .type = type,
+        .section = 0,
+        .offset = offset,
+        .len = lexer_previous_end(lexer) - offset,
+        .first_child = nodes->count,
+        .child_count = child_count
+    };
 
-        RETURN_ERROR_IF_TOKEN_NOT(T_K_LIKE, lexer);
+    if (child_count > 0) {
+        ast_nodes_reserve(nodes, child_count, parse_state->arena);
 
-        return parse_expression(lexer, parse_result, parse_state);
+        memcpy(nodes->items + nodes->count, stack->items + mark, child_count * sizeof(struct tsqlp_ast_node));
+        nodes->count += child_count;
     }
 
-    if (token_is_of_type(T_K_NOT, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    stack->count = mark;
+
+    parse_state_ast_push(parse_state, node);
+}
+
+static void parse_state_ast_close_section(struct parse_state *parse_state, struct lexer *lexer, unsigned int section,
+                                          size_t offset, size_t tokens_consumed, size_t mark) {
+    // Empty sections have no node
+    if (!parse_state->has_ast || tokens_consumed == lexer_tokens_consumed(lexer)) {
+        return;
     }
 
-    switch (token_type(lexer_peek(lexer))) {
-        case T_K_REGEXP:
-            lexer_consume(lexer);
+    parse_state_ast_close(parse_state, lexer, TSQLP_AST_SECTION, offset, mark);
 
-            return parse_expression(lexer, parse_result, parse_state);
-        case T_K_BETWEEN:
-            lexer_consume(lexer);
+    parse_state->ast_stack.items[parse_state->ast_stack.count - 1].section = section;
+}
 
-            RETURN_IF_NOT_OK(parse_predicate_expression(lexer, parse_result, parse_state));
-            RETURN_ERROR_IF_TOKEN_NOT(T_K_AND, lexer);
+// Moves the root statement, the only node left on the stack, to the end of the AST
+static struct tsqlp_ast parse_state_ast_finish(struct parse_state *parse_state) {
+    struct ast_nodes *nodes = &parse_state->ast_nodes;
 
-            return parse_expression(lexer, parse_result, parse_state);
-        case T_K_LIKE:
-            lexer_consume(lexer);
+    ast_nodes_reserve(nodes, 1, parse_state->arena);
 
-            RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
+    nodes->items[nodes->count++] = parse_state->ast_stack.items[0];
 
-            RETURN_SUCCESS_IF_TOKEN_NOT(T_K_ESCAPE, lexer);
+    return (struct tsqlp_ast) {
+        .nodes = nodes->items,
+        .count = nodes->count
+    };
+}
 
-            return parse_expression(lexer, parse_result, parse_state);
-        case T_K_IN:
-            lexer_consume(lexer);
+#define TRACK_SECTION(section, flag, lexer, parse_result, parse_state, call) \
+    do { \
+        if ((parse_state)->callback != NULL) { \
+            unsigned int enclosing_section = (parse_state)->event_section; \
+            size_t position = lexer_peek_position(lexer); \
+            size_t tokens_consumed = lexer_tokens_consumed(lexer); \
+            \
+            parse_state_start_section_events(parse_state, flag, position); \
+            \
+            tsqlp_parse_status status = call; \
+            \
+            if (status == TSQLP_PARSE_OK) { \
+                status = parse_state_finish_section_events(parse_state, lexer, position, tokens_consumed); \
+            } \
+            \
+            (parse_state)->event_section = enclosing_section; \
+            \
+            return status; \
+        } \
+        \
+        size_t position = lexer_peek_position(lexer); \
+        size_t tokens_consumed = lexer_tokens_consumed(lexer); \
+        size_t ast_mark = parse_state_ast_mark(parse_state); \
+        tsqlp_parse_status status; \
+        \
+        if (!((parse_state)->sections & (flag)) || (parse_state)->skipped_sections > 0) { \
+            (parse_state)->skipped_sections++; \
+            status = call; \
+            (parse_state)->skipped_sections--; \
+        } else if (parse_state_start_counting(parse_state, position) == STARTED_TRACKING_PLACEHOLDERS) { \
+            status = call; \
+            \
+            size_t section_end = lexer_previous_end(lexer); \
+            \
+            if (tokens_consumed == lexer_tokens_consumed(lexer)) { \
+                section_end = position; \
+            } \
+            \
+            struct tsqlp_placeholders tsqlp_placeholders = parse_state_finish_counting(parse_state, section_end); \
+            \
+            if (tokens_consumed < lexer_tokens_consumed(lexer) && parse_state->use_views) { \
+                tsqlp_sql_section_view( \
+                    lexer_buffer(lexer) + position, \
+                    section_end - position, \
+                    tsqlp_placeholders, \
+                    &parse_result->section \
+                ); \
+            } else if (tokens_consumed < lexer_tokens_consumed(lexer)) { \
+                tsqlp_sql_section_update( \
+                    lexer_buffer(lexer) + position, \
+                    section_end - position, \
+                    tsqlp_placeholders, \
+                    &parse_result->section, \
+                    parse_state->arena \
+                ); \
+            } \
+        } else { \
+            status = call; \
+        } \
+        \
+        if (status == TSQLP_PARSE_OK) { \
+            parse_state_ast_close_section(parse_state, lexer, flag, position, tokens_consumed, ast_mark); \
+        } \
+        \
+        return status; \
+    } while (0)
 
-            RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
-            RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
+/*
+ * Every recursion of the parser goes through an expression or a statement, which are counted as nesting levels so that
+ * deeply nested input fails with an error instead of exhausting the stack
+ */
+#define PARSE_NESTED(parse_state, call) \
+    do { \
+        if ((parse_state)->depth >= (parse_state)->max_depth) { \
+            return TSQLP_PARSE_NESTING_TOO_DEEP; \
+        } \
+        \
+        (parse_state)->depth++; \
+        tsqlp_parse_status status = call; \
+        (parse_state)->depth--; \
+        \
+        return status; \
+    } while (0)
 
-            while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+/*
+ * Binary operator precedence from the lowest to the highest, following the MySQL operator precedence table
+ */
+typedef enum {
+    PRECEDENCE_NONE,
+    PRECEDENCE_OR,
+    PRECEDENCE_XOR,
+    PRECEDENCE_AND,
+    PRECEDENCE_NOT,
+    PRECEDENCE_COMPARISON,
+    PRECEDENCE_BIT_OR,
+    PRECEDENCE_BIT_AND,
+    PRECEDENCE_SHIFT,
+    PRECEDENCE_ADDITIVE,
+    PRECEDENCE_MULTIPLICATIVE,
+    PRECEDENCE_BIT_XOR,
+    PRECEDENCE_UNARY,
+    PRECEDENCE_COLLATE
+} operator_precedence;
+
+/*
+ * What follows an infix operator, a plain right operand unless stated otherwise
+ */
+typedef enum {
+    OPERATOR_BINARY,
+    // Right operand or ALL / ANY subquery
+    OPERATOR_COMPARISON,
+    // [NOT] UNKNOWN | NULL | TRUE | FALSE
+    OPERATOR_IS,
+    // Operand AND operand
+    OPERATOR_BETWEEN,
+    // Right operand and optional ESCAPE operand
+    OPERATOR_LIKE,
+    // Parenthesized expression list
+    OPERATOR_IN,
+    // LIKE and right operand
+    OPERATOR_SOUNDS,
+    // Collation identifier
+    OPERATOR_COLLATE,
+    // Negates the following LIKE, REGEXP, BETWEEN or IN
+    OPERATOR_NOT
+} operator_form;
+
+struct infix_operator {
+    operator_precedence precedence;
+    operator_form form;
+    int is_negatable;
+};
 
-                RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
-            }
+/*
+ * Tokens which are not listed have PRECEDENCE_NONE and end the expression
+ */
+static const struct infix_operator infix_operators[] = {
+    [T_K_OR] = {PRECEDENCE_OR, OPERATOR_BINARY, 0},
+    [T_OR] = {PRECEDENCE_OR, OPERATOR_BINARY, 0},
+    [T_K_XOR] = {PRECEDENCE_XOR, OPERATOR_BINARY, 0},
+    [T_K_AND] = {PRECEDENCE_AND, OPERATOR_BINARY, 0},
+    [T_AND] = {PRECEDENCE_AND, OPERATOR_BINARY, 0},
+    [T_K_NOT] = {PRECEDENCE_NONE, OPERATOR_NOT, 0},
+    [T_COMPARISON_OPERATOR] = {PRECEDENCE_COMPARISON, OPERATOR_COMPARISON, 0},
+    [T_K_IS] = {PRECEDENCE_COMPARISON, OPERATOR_IS, 0},
+    [T_K_LIKE] = {PRECEDENCE_COMPARISON, OPERATOR_LIKE, 1},
+    [T_K_REGEXP] = {PRECEDENCE_COMPARISON, OPERATOR_BINARY, 1},
+    [T_K_BETWEEN] = {PRECEDENCE_COMPARISON, OPERATOR_BETWEEN, 1},
+    [T_K_IN] = {PRECEDENCE_COMPARISON, OPERATOR_IN, 1},
+    [T_K_SOUNDS] = {PRECEDENCE_COMPARISON, OPERATOR_SOUNDS, 0},
+    [T_BIT_OR] = {PRECEDENCE_BIT_OR, OPERATOR_BINARY, 0},
+    [T_BIT_AND] = {PRECEDENCE_BIT_AND, OPERATOR_BINARY, 0},
+    [T_LEFT_SHIFT] = {PRECEDENCE_SHIFT, OPERATOR_BINARY, 0},
+    [T_RIGHT_SHIFT] = {PRECEDENCE_SHIFT, OPERATOR_BINARY, 0},
+    [T_PLUS] = {PRECEDENCE_ADDITIVE, OPERATOR_BINARY, 0},
+    [T_MINUS] = {PRECEDENCE_ADDITIVE, OPERATOR_BINARY, 0},
+    [T_MULT] = {PRECEDENCE_MULTIPLICATIVE, OPERATOR_BINARY, 0},
+    [T_DIV] = {PRECEDENCE_MULTIPLICATIVE, OPERATOR_BINARY, 0},
+    [T_K_DIV] = {PRECEDENCE_MULTIPLICATIVE, OPERATOR_BINARY, 0},
+    [T_MOD] = {PRECEDENCE_MULTIPLICATIVE, OPERATOR_BINARY, 0},
+    [T_K_MOD] = {PRECEDENCE_MULTIPLICATIVE, OPERATOR_BINARY, 0},
+    [T_BIT_XOR] = {PRECEDENCE_BIT_XOR, OPERATOR_BINARY, 0},
+    [T_ARROW] = {PRECEDENCE_COMPARISON, OPERATOR_COMPARISON, 0},
+    [T_K_COLLATE] = {PRECEDENCE_COLLATE, OPERATOR_COLLATE, 0},
+};
 
-            RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
+/*
+ * Precedence of the operand following a prefix operator
+ */
+static const operator_precedence prefix_operators[] = {
+    [T_K_NOT] = PRECEDENCE_NOT,
+    [T_PLUS] = PRECEDENCE_UNARY,
+    [T_MINUS] = PRECEDENCE_UNARY,
+    [T_BIT_NOT] = PRECEDENCE_UNARY,
+    [T_NOT] = PRECEDENCE_UNARY,
+    [T_K_BINARY] = PRECEDENCE_COLLATE,
+};
 
-            return TSQLP_PARSE_OK;
-        default:
-            return TSQLP_PARSE_OK;
-    }
+static const struct infix_operator *infix_operator_of(sql_token_type type) {
+    static const struct infix_operator none = {PRECEDENCE_NONE, OPERATOR_BINARY, 0};
+
+    return (size_t) type < sizeof(infix_operators) / sizeof(infix_operators[0]) ? &infix_operators[type] : &none;
+}
+
+static operator_precedence prefix_precedence_of(sql_token_type type) {
+    return (size_t) type < sizeof(prefix_operators) / sizeof(prefix_operators[0])
+           ? prefix_operators[type]
+           : PRECEDENCE_NONE;
 }
 
+static tsqlp_parse_status parse_subexpression(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
+                                              struct parse_state *parse_state, operator_precedence min_precedence);
+
+/*
+ * Precedence climbing: an operand followed by every infix operator binding at least as tight as min_precedence. Right
+ * operands are parsed one level tighter than their operator, so chains of the same or looser operators like
+ * "a = ? OR a = ? OR ..." or "? + ? + ..." continue in the loop and only a tighter operator nests
+ */
 static tsqlp_parse_status
-parse_arithm_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
+parse_subexpression_inner(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
+                          struct parse_state *parse_state, operator_precedence min_precedence) {
+    // Every operator takes the operation before it, so the nodes of "a + b + c" are (a + b) + c
+    size_t offset = parse_state_ast_offset(parse_state, lexer);
+    size_t ast_mark = parse_state_ast_mark(parse_state);
+
     RETURN_IF_NOT_OK(parse_simple_expression(lexer, parse_result, parse_state));
 
-    switch (token_type(lexer_peek(lexer))) {
-        case T_BIT_OR:
-            //intentional
-        case T_BIT_AND:
-            //intentional
-        case T_LEFT_SHIFT:
-            //intentional
-        case T_RIGHT_SHIFT:
-            //intentional
-        case T_PLUS:
-            //intentional
-        case T_MINUS:
-            //intentional
-        case T_MULT:
-            //intentional
-        case T_DIV:
-            //intentional
-        case T_K_DIV:
-            //intentional
-        case T_K_MOD:
-            //intentional
-        case T_MOD:
-            //intentional
-        case T_BIT_XOR:
-            lexer_consume(lexer);
+    while (1) {
+        const struct infix_operator *operator = infix_operator_of(lexer_peek_type(lexer));
+        int is_negated = operator->form == OPERATOR_NOT;
 
-            break;
-        case T_K_COLLATE:
-            lexer_consume(lexer);
+        if (is_negated) {
+            operator = infix_operator_of(token_type(lexer_peek_next(lexer)));
 
-            RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
+            if (!operator->is_negatable) {
+                return TSQLP_PARSE_OK;
+            }
+        }
 
+        if (operator->precedence < min_precedence) {
             return TSQLP_PARSE_OK;
-        default:
-            return TSQLP_PARSE_OK;
-    }
+        }
 
-    return parse_expression(lexer, parse_result, parse_state);
-}
+        if (is_negated) {
+            lexer_skip(lexer);
+        }
 
-static tsqlp_parse_status
-parse_simple_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    switch (token_type(lexer_peek(lexer))) {
-        case T_K_ROW:
-            lexer_consume(lexer);
+        lexer_skip(lexer);
 
-            RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
+        operator_precedence operand_precedence = operator->precedence + 1;
 
-            RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
+        switch (operator->form) {
+            case OPERATOR_COMPARISON:
+                if (lexer_peek_type(lexer) == T_K_ALL || lexer_peek_type(lexer) == T_K_ANY) {
+                    lexer_skip(lexer);
 
-            while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+                    RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
+                    RETURN_IF_NOT_OK(parse_stmt(lexer, parse_result, parse_state));
+                    RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
 
-                RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
+                    break;
+                }
+
+                RETURN_IF_NOT_OK(parse_subexpression(lexer, parse_result, parse_state, operand_precedence));
+
+                break;
+            case OPERATOR_IS: {
+                CONSUME_IF_TOKEN(T_K_NOT, lexer);
+
+                sql_token_type type = lexer_peek_type(lexer);
+
+                if (type != T_K_UNKNOWN && type != T_K_NULL && type != T_K_TRUE && type != T_K_FALSE) {
+                    return TSQLP_PARSE_INVALID_SYNTAX;
+                }
+
+                lexer_skip(lexer);
+
+                break;
             }
+            case OPERATOR_BETWEEN:
+                RETURN_IF_NOT_OK(parse_subexpression(lexer, parse_result, parse_state, operand_precedence));
+                RETURN_ERROR_IF_TOKEN_NOT(T_K_AND, lexer);
+                RETURN_IF_NOT_OK(parse_subexpression(lexer, parse_result, parse_state, operand_precedence));
 
-            RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
+                break;
+            case OPERATOR_LIKE:
+                RETURN_IF_NOT_OK(parse_subexpression(lexer, parse_result, parse_state, operand_precedence));
 
-            return TSQLP_PARSE_OK;
-        case T_NUMBER:
-            // intentional
-        case T_BIT_VALUE:
-            // intentional
-        case T_HEX_VALUE:
-            // intentional
-        case T_K_TRUE:
-            // intentional
-        case T_K_FALSE:
+                if (lexer_peek_type(lexer) == T_K_ESCAPE) {
+                    lexer_skip(lexer);
+
+                    RETURN_IF_NOT_OK(parse_subexpression(lexer, parse_result, parse_state, operand_precedence));
+                }
+
+                break;
+            case OPERATOR_IN:
+                RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
+                RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
+
+                while (lexer_peek_type(lexer) == T_COMMA) {
+                    lexer_skip(lexer);
+
+                    RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
+                }
+
+                RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
+
+                break;
+            case OPERATOR_SOUNDS:
+                RETURN_ERROR_IF_TOKEN_NOT(T_K_LIKE, lexer);
+                RETURN_IF_NOT_OK(parse_subexpression(lexer, parse_result, parse_state, operand_precedence));
+
+                break;
+            case OPERATOR_COLLATE:
+                RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
+
+                break;
+            default:
+                RETURN_IF_NOT_OK(parse_subexpression(lexer, parse_result, parse_state, operand_precedence));
+
+                break;
+        }
+
+        parse_state_ast_close(parse_state, lexer, TSQLP_AST_OPERATOR, offset, ast_mark);
+    }
+}
+
+static tsqlp_parse_status parse_subexpression(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
+                                              struct parse_state *parse_state, operator_precedence min_precedence) {
+    PARSE_NESTED(parse_state, parse_subexpression_inner(lexer, parse_result, parse_state, min_precedence));
+}
+
+static tsqlp_parse_status
+parse_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
+    return parse_subexpression(lexer, parse_result, parse_state, PRECEDENCE_OR);
+}
+
+static tsqlp_parse_status
+parse_simple_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
+    operator_precedence prefix_precedence = prefix_precedence_of(lexer_peek_type(lexer));
+    size_t offset = parse_state_ast_offset(parse_state, lexer);
+    size_t ast_mark = parse_state_ast_mark(parse_state);
+
+    if (prefix_precedence != PRECEDENCE_NONE) {
+        lexer_skip(lexer);
+
+        RETURN_IF_NOT_OK(parse_subexpression(lexer, parse_result, parse_state, prefix_precedence));
+
+        parse_state_ast_close(parse_state, lexer, TSQLP_AST_UNARY_OPERATOR, offset, ast_mark);
+
+        return TSQLP_PARSE_OK;
+    }
+
+    switch (lexer_peek_type(lexer)) {
+        case T_K_ROW:
+            lexer_skip(lexer);
+
+            RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
+
+            RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
+
+            while (lexer_peek_type(lexer) == T_COMMA) {
+                lexer_skip(lexer);
+
+                RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
+            }
+
+            RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
+
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_LIST, offset, ast_mark);
+
+            return TSQLP_PARSE_OK;
+        case T_NUMBER:
+            // intentional
+        case T_BIT_VALUE:
+            // intentional
+        case T_HEX_VALUE:
+            // intentional
+        case T_K_TRUE:
+            // intentional
+        case T_K_FALSE:
             // intentional
         case T_VARIABLE:
             // intentional
@@ -385,47 +959,50 @@ parse_simple_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_re
             // intentional
         case T_WILDCARD_IDENTIFIER:
             // intentional
-        case T_K_NULL:
-            lexer_consume(lexer);
+        case T_STRING:
+            // intentional
+        case T_K_NULL: {
+            struct token token = lexer_consume(lexer);
 
-            return TSQLP_PARSE_OK;
+            parse_state_ast_operand(parse_state, &token);
+
+            return parse_state_emit_operand(parse_state, &token);
+        }
         case T_K_DATE:
             // intentional
         case T_K_TIME:
             // intentional
         case T_K_TIMESTAMP:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
             RETURN_ERROR_IF_TOKEN_NOT(T_STRING, lexer);
 
-            return TSQLP_PARSE_OK;
-        case T_STRING:
-            // intentional
-            lexer_consume(lexer);
-
-            if (token_is_of_type(T_K_COLLATE, lexer_peek(lexer))) {
-                lexer_consume(lexer);
-
-                RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
-            }
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_LITERAL, offset, ast_mark);
 
-            return TSQLP_PARSE_OK;
+            return parse_state_emit_token(parse_state, TSQLP_EVENT_LITERAL, lexer_peek_previous(lexer));
         case T_PLACEHOLDER: {
             struct token token = lexer_consume(lexer);
-            parse_state_register_placeholder(parse_state, token_position(&token));
 
-            return TSQLP_PARSE_OK;
+            return parse_state_register_placeholder(parse_state, &token);
         }
-        case T_IDENTIFIER:
-            lexer_consume(lexer);
+        case T_IDENTIFIER: {
+            struct token token = lexer_consume(lexer);
+
+            RETURN_IF_NOT_OK(parse_state_emit_operand(parse_state, &token));
 
-            RETURN_SUCCESS_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
+            if (lexer_peek_type(lexer) != T_OPEN_PAREN) {
+                parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, &token);
 
-            if (!token_is_of_type(T_CLOSE_PAREN, lexer_peek(lexer))) {
+                return TSQLP_PARSE_OK;
+            }
+
+            lexer_skip(lexer);
+
+            if (lexer_peek_type(lexer) != T_CLOSE_PAREN) {
                 RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
 
-                while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                while (lexer_peek_type(lexer) == T_COMMA) {
+                    lexer_skip(lexer);
 
                     RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
                 }
@@ -433,65 +1010,60 @@ parse_simple_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_re
 
             RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
 
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_FUNCTION, offset, ast_mark);
+
             return TSQLP_PARSE_OK;
+        }
         case T_K_EXISTS:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
             RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
             RETURN_IF_NOT_OK(parse_stmt(lexer, parse_result, parse_state));
             RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
 
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_EXISTS, offset, ast_mark);
+
             return TSQLP_PARSE_OK;
         case T_K_SELECT:
             return parse_stmt(lexer, parse_result, parse_state);
         case T_OPEN_PAREN:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
             RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
 
-            while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            while (lexer_peek_type(lexer) == T_COMMA) {
+                lexer_skip(lexer);
 
                 RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
             }
 
             RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
 
-            return TSQLP_PARSE_OK;
-        case T_PLUS:
-            // intentional
-        case T_MINUS:
-            // intentional
-        case T_NOT:
-            // intentional
-        case T_K_NOT:
-            // intentional
-        case T_BIT_NOT:
-            // intentional
-        case T_K_BINARY:
-            lexer_consume(lexer);
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_LIST, offset, ast_mark);
 
-            return parse_expression(lexer, parse_result, parse_state);
+            return TSQLP_PARSE_OK;
         case T_K_INTERVAL:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
             RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
             RETURN_ERROR_IF_TOKEN_NOT(T_INTERVAL_UNIT, lexer);
 
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_INTERVAL, offset, ast_mark);
+
             return TSQLP_PARSE_OK;
         case T_K_CASE:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
-            if (!token_is_of_type(T_K_WHEN, lexer_peek(lexer))) {
+            if (lexer_peek_type(lexer) != T_K_WHEN) {
                 RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
             }
 
-            if (!token_is_of_type(T_K_WHEN, lexer_peek(lexer))) {
+            if (lexer_peek_type(lexer) != T_K_WHEN) {
                 return TSQLP_PARSE_INVALID_SYNTAX;
             }
 
-            while (token_is_of_type(T_K_WHEN, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            while (lexer_peek_type(lexer) == T_K_WHEN) {
+                lexer_skip(lexer);
 
                 RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
                 RETURN_ERROR_IF_TOKEN_NOT(T_K_THEN, lexer);
@@ -499,23 +1071,25 @@ parse_simple_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_re
 
             }
 
-            if (token_is_of_type(T_K_ELSE, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            if (lexer_peek_type(lexer) == T_K_ELSE) {
+                lexer_skip(lexer);
 
                 RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
             }
 
             RETURN_ERROR_IF_TOKEN_NOT(T_K_END, lexer);
 
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_CASE, offset, ast_mark);
+
             return TSQLP_PARSE_OK;
         case T_K_MATCH:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
             RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
             RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
 
-            while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            while (lexer_peek_type(lexer) == T_COMMA) {
+                lexer_skip(lexer);
 
                 RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
             }
@@ -524,28 +1098,28 @@ parse_simple_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_re
             RETURN_ERROR_IF_TOKEN_NOT(T_K_AGAINST, lexer);
             RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
 
-            RETURN_IF_NOT_OK(parse_arithm_expression(lexer, parse_result, parse_state));
+            RETURN_IF_NOT_OK(parse_subexpression(lexer, parse_result, parse_state, PRECEDENCE_BIT_OR));
 
-            if (token_is_of_type(T_K_WITH, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            if (lexer_peek_type(lexer) == T_K_WITH) {
+                lexer_skip(lexer);
 
                 RETURN_ERROR_IF_TOKEN_NOT(T_K_QUERY, lexer);
                 RETURN_ERROR_IF_TOKEN_NOT(T_K_EXPANSION, lexer);
-            } else if (token_is_of_type(T_K_IN, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            } else if (lexer_peek_type(lexer) == T_K_IN) {
+                lexer_skip(lexer);
 
-                if (token_is_of_type(T_K_BOOLEAN, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                if (lexer_peek_type(lexer) == T_K_BOOLEAN) {
+                    lexer_skip(lexer);
 
                     RETURN_ERROR_IF_TOKEN_NOT(T_K_MODE, lexer);
-                } else if (token_is_of_type(T_K_NATURAL, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                } else if (lexer_peek_type(lexer) == T_K_NATURAL) {
+                    lexer_skip(lexer);
 
                     RETURN_ERROR_IF_TOKEN_NOT(T_K_LANGUAGE, lexer);
                     RETURN_ERROR_IF_TOKEN_NOT(T_K_MODE, lexer);
 
-                    if (token_is_of_type(T_K_WITH, lexer_peek(lexer))) {
-                        lexer_consume(lexer);
+                    if (lexer_peek_type(lexer) == T_K_WITH) {
+                        lexer_skip(lexer);
 
                         RETURN_ERROR_IF_TOKEN_NOT(T_K_QUERY, lexer);
                         RETURN_ERROR_IF_TOKEN_NOT(T_K_EXPANSION, lexer);
@@ -555,6 +1129,8 @@ parse_simple_expression(struct lexer *lexer, struct tsqlp_parse_result *parse_re
 
             RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
 
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_MATCH, offset, ast_mark);
+
             return TSQLP_PARSE_OK;
         default:
             return TSQLP_PARSE_INVALID_SYNTAX;
@@ -566,7 +1142,7 @@ static tsqlp_parse_status parse_modifiers_inner(struct lexer *lexer) {
 
     if (token_is_of_type(T_K_ALL, token) || token_is_of_type(T_K_DISTINCT, token) ||
         token_is_of_type(T_K_DISTINCTROW, token)) {
-        lexer_consume(lexer);
+        lexer_skip(lexer);
     }
 
     CONSUME_IF_TOKEN(T_K_HIGH_PRIORITY, lexer);
@@ -579,7 +1155,7 @@ static tsqlp_parse_status parse_modifiers_inner(struct lexer *lexer) {
 
     if (token_is_of_type(T_K_SQL_CACHE, token) || token_is_of_type(T_K_SQL_NO_CACHE, token) ||
         token_is_of_type(T_K_SQL_CALC_FOUND_ROWS, token)) {
-        lexer_consume(lexer);
+        lexer_skip(lexer);
     }
 
     return TSQLP_PARSE_OK;
@@ -587,24 +1163,24 @@ static tsqlp_parse_status parse_modifiers_inner(struct lexer *lexer) {
 
 static tsqlp_parse_status
 parse_modifiers(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    TRACK_SECTION(modifiers, lexer, parse_result, parse_state, parse_modifiers_inner(lexer));
+    TRACK_SECTION(modifiers, TSQLP_SECTION_MODIFIERS, lexer, parse_result, parse_state, parse_modifiers_inner(lexer));
 }
 
 static tsqlp_parse_status
 parse_columns_inner(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
     RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
 
-    RETURN_IF_NOT_OK(parse_alias(lexer));
+    RETURN_IF_NOT_OK(parse_alias(lexer, parse_state));
 
     while (1) {
-        if (!token_is_of_type(T_COMMA, lexer_peek(lexer))) {
+        if (lexer_peek_type(lexer) != T_COMMA) {
             break;
         }
 
-        lexer_consume(lexer);
+        lexer_skip(lexer);
 
         RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
-        RETURN_IF_NOT_OK(parse_alias(lexer));
+        RETURN_IF_NOT_OK(parse_alias(lexer, parse_state));
     }
 
     return TSQLP_PARSE_OK;
@@ -612,39 +1188,39 @@ parse_columns_inner(struct lexer *lexer, struct tsqlp_parse_result *parse_result
 
 static tsqlp_parse_status
 parse_columns(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    TRACK_SECTION(columns, lexer, parse_result, parse_state, parse_columns_inner(lexer, parse_result, parse_state));
+    TRACK_SECTION(columns, TSQLP_SECTION_COLUMNS, lexer, parse_result, parse_state, parse_columns_inner(lexer, parse_result, parse_state));
 }
 
 static tsqlp_parse_status parse_first_into_inner(struct lexer *lexer) {
     RETURN_SUCCESS_IF_TOKEN_NOT(T_K_INTO, lexer);
 
-    switch (token_type(lexer_peek(lexer))) {
+    switch (lexer_peek_type(lexer)) {
         case T_K_OUTFILE:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
             RETURN_ERROR_IF_TOKEN_NOT(T_STRING, lexer);
 
-            if (token_is_of_type(T_K_CHARACTER, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            if (lexer_peek_type(lexer) == T_K_CHARACTER) {
+                lexer_skip(lexer);
 
                 RETURN_ERROR_IF_TOKEN_NOT(T_K_SET, lexer);
                 RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
             }
 
-            if (token_is_of_type(T_K_FIELDS, lexer_peek(lexer)) || token_is_of_type(T_K_COLUMNS, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            if (lexer_peek_type(lexer) == T_K_FIELDS || lexer_peek_type(lexer) == T_K_COLUMNS) {
+                lexer_skip(lexer);
 
 
-                if (token_is_of_type(T_K_TERMINATED, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                if (lexer_peek_type(lexer) == T_K_TERMINATED) {
+                    lexer_skip(lexer);
 
                     RETURN_ERROR_IF_TOKEN_NOT(T_K_BY, lexer);
                     RETURN_ERROR_IF_TOKEN_NOT(T_STRING, lexer);
                 }
 
 
-                if (token_is_of_type(T_K_ENCLOSED, lexer_peek(lexer)) ||
-                    token_is_of_type(T_K_OPTIONALLY, lexer_peek(lexer))) {
+                if (lexer_peek_type(lexer) == T_K_ENCLOSED ||
+                    lexer_peek_type(lexer) == T_K_OPTIONALLY) {
                     struct token token = lexer_consume(lexer);
 
                     if (token_is_of_type(T_K_OPTIONALLY, &token)) {
@@ -656,26 +1232,26 @@ static tsqlp_parse_status parse_first_into_inner(struct lexer *lexer) {
                 }
 
 
-                if (token_is_of_type(T_K_ESCAPED, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                if (lexer_peek_type(lexer) == T_K_ESCAPED) {
+                    lexer_skip(lexer);
 
                     RETURN_ERROR_IF_TOKEN_NOT(T_K_BY, lexer);
                     RETURN_ERROR_IF_TOKEN_NOT(T_STRING, lexer);
                 }
             }
 
-            if (token_is_of_type(T_K_LINES, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            if (lexer_peek_type(lexer) == T_K_LINES) {
+                lexer_skip(lexer);
 
-                if (token_is_of_type(T_K_STARTING, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                if (lexer_peek_type(lexer) == T_K_STARTING) {
+                    lexer_skip(lexer);
 
                     RETURN_ERROR_IF_TOKEN_NOT(T_K_BY, lexer);
                     RETURN_ERROR_IF_TOKEN_NOT(T_STRING, lexer);
                 }
 
-                if (token_is_of_type(T_K_TERMINATED, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                if (lexer_peek_type(lexer) == T_K_TERMINATED) {
+                    lexer_skip(lexer);
 
                     RETURN_ERROR_IF_TOKEN_NOT(T_K_BY, lexer);
                     RETURN_ERROR_IF_TOKEN_NOT(T_STRING, lexer);
@@ -684,16 +1260,16 @@ static tsqlp_parse_status parse_first_into_inner(struct lexer *lexer) {
 
             return TSQLP_PARSE_OK;
         case T_K_DUMPFILE:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
             RETURN_ERROR_IF_TOKEN_NOT(T_STRING, lexer);
 
             return TSQLP_PARSE_OK;
         case T_VARIABLE:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
-            while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            while (lexer_peek_type(lexer) == T_COMMA) {
+                lexer_skip(lexer);
 
                 RETURN_ERROR_IF_TOKEN_NOT(T_VARIABLE, lexer);
             }
@@ -706,22 +1282,22 @@ static tsqlp_parse_status parse_first_into_inner(struct lexer *lexer) {
 
 static tsqlp_parse_status
 parse_first_into(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    TRACK_SECTION(first_into, lexer, parse_result, parse_state, parse_first_into_inner(lexer));
+    TRACK_SECTION(first_into, TSQLP_SECTION_FIRST_INTO, lexer, parse_result, parse_state, parse_first_into_inner(lexer));
 }
 
 static tsqlp_parse_status
 parse_tables(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
     RETURN_SUCCESS_IF_TOKEN_NOT(T_K_FROM, lexer);
 
-    TRACK_SECTION(tables, lexer, parse_result, parse_state, parse_table_list(lexer, parse_result, parse_state));
+    TRACK_SECTION(tables, TSQLP_SECTION_TABLES, lexer, parse_result, parse_state, parse_table_list(lexer, parse_result, parse_state));
 }
 
 static tsqlp_parse_status
 parse_table_list(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
     RETURN_IF_NOT_OK(parse_joined_table(lexer, parse_result, parse_state));
 
-    while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    while (lexer_peek_type(lexer) == T_COMMA) {
+        lexer_skip(lexer);
 
         RETURN_IF_NOT_OK(parse_joined_table(lexer, parse_result, parse_state));
     }
@@ -732,17 +1308,20 @@ parse_table_list(struct lexer *lexer, struct tsqlp_parse_result *parse_result, s
 
 static tsqlp_parse_status
 parse_joined_table(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
+    // Joins nest to the left, the first one is the left table of the second one and so on
+    size_t offset = parse_state_ast_offset(parse_state, lexer);
+    size_t ast_mark = parse_state_ast_mark(parse_state);
 
     RETURN_IF_NOT_OK(parse_table_factor(lexer, parse_result, parse_state));
 
     while (1) {
-        switch (token_type(lexer_peek(lexer))) {
+        switch (lexer_peek_type(lexer)) {
             case T_K_INNER:
                 // intentional
             case T_K_CROSS:
                 // intentional
             case T_K_STRAIGHT:
-                lexer_consume(lexer);
+                lexer_skip(lexer);
 
                 RETURN_ERROR_IF_TOKEN_NOT(T_K_JOIN, lexer);
 
@@ -752,7 +1331,7 @@ parse_joined_table(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
 
                 break;
             case T_K_JOIN:
-                lexer_consume(lexer);
+                lexer_skip(lexer);
 
                 RETURN_IF_NOT_OK(parse_table_factor(lexer, parse_result, parse_state));
 
@@ -762,10 +1341,10 @@ parse_joined_table(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
             case T_K_LEFT:
                 // intentional
             case T_K_RIGHT:
-                lexer_consume(lexer);
+                lexer_skip(lexer);
 
-                if (token_is_of_type(T_K_OUTER, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                if (lexer_peek_type(lexer) == T_K_OUTER) {
+                    lexer_skip(lexer);
                 }
 
                 RETURN_ERROR_IF_TOKEN_NOT(T_K_JOIN, lexer);
@@ -775,14 +1354,14 @@ parse_joined_table(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
 
                 break;
             case T_K_NATURAL:
-                lexer_consume(lexer);
+                lexer_skip(lexer);
 
-                if (token_is_of_type(T_K_INNER, lexer_peek(lexer)) || token_is_of_type(T_K_LEFT, lexer_peek(lexer)) ||
-                    token_is_of_type(T_K_RIGHT, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                if (lexer_peek_type(lexer) == T_K_INNER || lexer_peek_type(lexer) == T_K_LEFT ||
+                    lexer_peek_type(lexer) == T_K_RIGHT) {
+                    lexer_skip(lexer);
 
-                    if (token_is_of_type(T_K_OUTER, lexer_peek(lexer))) {
-                        lexer_consume(lexer);
+                    if (lexer_peek_type(lexer) == T_K_OUTER) {
+                        lexer_skip(lexer);
                     }
                 }
 
@@ -794,6 +1373,8 @@ parse_joined_table(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
             default:
                 return TSQLP_PARSE_OK;
         }
+
+        parse_state_ast_close(parse_state, lexer, TSQLP_AST_JOIN, offset, ast_mark);
     }
 }
 
@@ -801,22 +1382,24 @@ static tsqlp_parse_status
 parse_join_specification(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state,
                          parse_strength strength
 ) {
-    switch (token_type(lexer_peek(lexer))) {
+    switch (lexer_peek_type(lexer)) {
         case T_K_ON:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
             return parse_expression(lexer, parse_result, parse_state);
         case T_K_USING:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
             RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
 
             RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
+            parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, lexer_peek_previous(lexer));
 
-            while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            while (lexer_peek_type(lexer) == T_COMMA) {
+                lexer_skip(lexer);
 
                 RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
+                parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, lexer_peek_previous(lexer));
             }
 
             RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
@@ -829,94 +1412,115 @@ parse_join_specification(struct lexer *lexer, struct tsqlp_parse_result *parse_r
 
 static tsqlp_parse_status
 parse_table_factor(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
+    size_t offset = parse_state_ast_offset(parse_state, lexer);
+    size_t ast_mark = parse_state_ast_mark(parse_state);
 
-    switch (token_type(lexer_peek(lexer))) {
+    switch (lexer_peek_type(lexer)) {
         case T_OPEN_PAREN:
-            lexer_consume(lexer);
+            lexer_skip(lexer);
 
-            if (token_is_of_type(T_K_SELECT, lexer_peek(lexer))) {
+            if (lexer_peek_type(lexer) == T_K_SELECT) {
                 RETURN_IF_NOT_OK(parse_stmt(lexer, parse_result, parse_state));
                 RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
 
-                RETURN_IF_NOT_OK(parse_alias(lexer));
+                RETURN_IF_NOT_OK(parse_alias(lexer, parse_state));
 
-                RETURN_SUCCESS_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
+                if (lexer_peek_type(lexer) == T_OPEN_PAREN) {
+                    lexer_skip(lexer);
 
-                if (!token_is_of_type(T_IDENTIFIER, lexer_peek(lexer)) &&
-                    !token_is_of_type(T_QUALIFIED_IDENTIFIER, lexer_peek(lexer))) {
-                    return TSQLP_PARSE_INVALID_SYNTAX;
-                }
+                    if (lexer_peek_type(lexer) != T_IDENTIFIER &&
+                        lexer_peek_type(lexer) != T_QUALIFIED_IDENTIFIER) {
+                        return TSQLP_PARSE_INVALID_SYNTAX;
+                    }
 
-                lexer_consume(lexer);
+                    struct token token = lexer_consume(lexer);
 
-                while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                    parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, &token);
 
-                    if (!token_is_of_type(T_IDENTIFIER, lexer_peek(lexer)) &&
-                        !token_is_of_type(T_QUALIFIED_IDENTIFIER, lexer_peek(lexer))) {
-                        return TSQLP_PARSE_INVALID_SYNTAX;
+                    while (lexer_peek_type(lexer) == T_COMMA) {
+                        lexer_skip(lexer);
+
+                        if (lexer_peek_type(lexer) != T_IDENTIFIER &&
+                            lexer_peek_type(lexer) != T_QUALIFIED_IDENTIFIER) {
+                            return TSQLP_PARSE_INVALID_SYNTAX;
+                        }
+
+                        token = lexer_consume(lexer);
+
+                        parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, &token);
                     }
 
-                    lexer_consume(lexer);
+                    RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
                 }
 
-                RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
+                parse_state_ast_close(parse_state, lexer, TSQLP_AST_DERIVED_TABLE, offset, ast_mark);
 
                 return TSQLP_PARSE_OK;
             }
 
             RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
+            parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, lexer_peek_previous(lexer));
 
-            while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-                lexer_consume(lexer);
+            while (lexer_peek_type(lexer) == T_COMMA) {
+                lexer_skip(lexer);
 
                 RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
+                parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, lexer_peek_previous(lexer));
             }
 
             RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
 
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_LIST, offset, ast_mark);
+
             return TSQLP_PARSE_OK;
         case T_PLACEHOLDER: {
             struct token token = lexer_consume(lexer);
 
-            parse_state_register_placeholder(parse_state, token_position(&token));
+            RETURN_IF_NOT_OK(parse_state_register_placeholder(parse_state, &token));
+            RETURN_IF_NOT_OK(parse_alias(lexer, parse_state));
 
-            RETURN_IF_NOT_OK(parse_alias(lexer));
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_TABLE, offset, ast_mark);
 
             return TSQLP_PARSE_OK;
         }
         case T_IDENTIFIER:
             // intentional
-        case T_QUALIFIED_IDENTIFIER:
-            lexer_consume(lexer);
+        case T_QUALIFIED_IDENTIFIER: {
+            struct token token = lexer_consume(lexer);
 
-            if (token_is_of_type(T_K_PARTITION, lexer_peek(lexer))) {
+            RETURN_IF_NOT_OK(parse_state_emit_token(parse_state, TSQLP_EVENT_IDENTIFIER, &token));
+            parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, &token);
+
+            if (lexer_peek_type(lexer) == T_K_PARTITION) {
                 RETURN_IF_NOT_OK(parse_partition(lexer));
             }
 
-            RETURN_IF_NOT_OK(parse_alias(lexer));
+            RETURN_IF_NOT_OK(parse_alias(lexer, parse_state));
 
             while (
-                token_is_of_type(T_K_USE, lexer_peek(lexer))
-                || token_is_of_type(T_K_FORCE, lexer_peek(lexer))
-                || token_is_of_type(T_K_IGNORE, lexer_peek(lexer))
+                lexer_peek_type(lexer) == T_K_USE
+                || lexer_peek_type(lexer) == T_K_FORCE
+                || lexer_peek_type(lexer) == T_K_IGNORE
                 ) {
-                lexer_consume(lexer);
+                size_t hint_offset = parse_state_ast_offset(parse_state, lexer);
+                size_t hint_ast_mark = parse_state_ast_mark(parse_state);
+
+                lexer_skip(lexer);
 
-                if (!token_is_of_type(T_K_INDEX, lexer_peek(lexer)) && !token_is_of_type(T_K_KEY, lexer_peek(lexer))) {
+                if (lexer_peek_type(lexer) != T_K_INDEX && lexer_peek_type(lexer) != T_K_KEY) {
                     return TSQLP_PARSE_INVALID_SYNTAX;
                 }
 
-                lexer_consume(lexer);
+                lexer_skip(lexer);
 
-                if (token_is_of_type(T_K_FOR, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                if (lexer_peek_type(lexer) == T_K_FOR) {
+                    lexer_skip(lexer);
 
-                    if (token_is_of_type(T_K_JOIN, lexer_peek(lexer))) {
-                        lexer_consume(lexer);
-                    } else if (token_is_of_type(T_K_ORDER, lexer_peek(lexer)) ||
-                               token_is_of_type(T_K_GROUP, lexer_peek(lexer))) {
-                        lexer_consume(lexer);
+                    if (lexer_peek_type(lexer) == T_K_JOIN) {
+                        lexer_skip(lexer);
+                    } else if (lexer_peek_type(lexer) == T_K_ORDER ||
+                               lexer_peek_type(lexer) == T_K_GROUP) {
+                        lexer_skip(lexer);
 
                         RETURN_ERROR_IF_TOKEN_NOT(T_K_BY, lexer);
                     }
@@ -924,24 +1528,28 @@ parse_table_factor(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
 
                 RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
                 RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
+                parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, lexer_peek_previous(lexer));
 
-                while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-                    lexer_consume(lexer);
+                while (lexer_peek_type(lexer) == T_COMMA) {
+                    lexer_skip(lexer);
 
                     RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
+                    parse_state_ast_leaf(parse_state, TSQLP_AST_IDENTIFIER, lexer_peek_previous(lexer));
                 }
 
                 RETURN_ERROR_IF_TOKEN_NOT(T_CLOSE_PAREN, lexer);
 
+                parse_state_ast_close(parse_state, lexer, TSQLP_AST_INDEX_HINT, hint_offset, hint_ast_mark);
+
                 if (
-                    token_is_of_type(T_COMMA, lexer_peek(lexer))
+                    lexer_peek_type(lexer) == T_COMMA
                     &&
                     (
                         token_is_of_type(T_K_USE, lexer_peek_next(lexer))
-                        || token_is_of_type(T_K_FORCE, lexer_peek(lexer))
-                        || token_is_of_type(T_K_IGNORE, lexer_peek(lexer))
+                        || lexer_peek_type(lexer) == T_K_FORCE
+                        || lexer_peek_type(lexer) == T_K_IGNORE
                     )) {
-                    lexer_consume(lexer);
+                    lexer_skip(lexer);
 
                     continue;
                 }
@@ -949,34 +1557,39 @@ parse_table_factor(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
                 break;
             }
 
+            parse_state_ast_close(parse_state, lexer, TSQLP_AST_TABLE, offset, ast_mark);
+
             return TSQLP_PARSE_OK;
+        }
         default:
 
             return TSQLP_PARSE_INVALID_SYNTAX;
     }
 }
 
-static tsqlp_parse_status parse_alias(struct lexer *lexer) {
-    if (token_is_of_type(T_K_AS, lexer_peek(lexer)) || token_is_of_type(T_IDENTIFIER, lexer_peek(lexer))) {
+static tsqlp_parse_status parse_alias(struct lexer *lexer, struct parse_state *parse_state) {
+    if (lexer_peek_type(lexer) == T_K_AS || lexer_peek_type(lexer) == T_IDENTIFIER) {
         struct token token = lexer_consume(lexer);
 
         if (token_is_of_type(T_K_AS, &token)) {
             RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
         }
+
+        parse_state_ast_leaf(parse_state, TSQLP_AST_ALIAS, lexer_peek_previous(lexer));
     }
 
     return TSQLP_PARSE_OK;
 }
 
 static tsqlp_parse_status parse_partition(struct lexer *lexer) {
-    if (token_is_of_type(T_K_PARTITION, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    if (lexer_peek_type(lexer) == T_K_PARTITION) {
+        lexer_skip(lexer);
 
         RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
         RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
 
-        while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-            lexer_consume(lexer);
+        while (lexer_peek_type(lexer) == T_COMMA) {
+            lexer_skip(lexer);
 
             RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
         }
@@ -990,10 +1603,10 @@ static tsqlp_parse_status parse_partition(struct lexer *lexer) {
 
 static tsqlp_parse_status
 parse_where(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    if (token_is_of_type(T_K_WHERE, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    if (lexer_peek_type(lexer) == T_K_WHERE) {
+        lexer_skip(lexer);
 
-        TRACK_SECTION(where, lexer, parse_result, parse_state, parse_expression(lexer, parse_result, parse_state));
+        TRACK_SECTION(where, TSQLP_SECTION_WHERE, lexer, parse_result, parse_state, parse_expression(lexer, parse_result, parse_state));
     }
 
     return TSQLP_PARSE_OK;
@@ -1002,17 +1615,17 @@ parse_where(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct
 static tsqlp_parse_status parse_group_by_inner(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
     RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
 
-    if (token_is_of_type(T_K_ASC, lexer_peek(lexer)) || token_is_of_type(T_K_DESC, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    if (lexer_peek_type(lexer) == T_K_ASC || lexer_peek_type(lexer) == T_K_DESC) {
+        lexer_skip(lexer);
     }
 
-    while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    while (lexer_peek_type(lexer) == T_COMMA) {
+        lexer_skip(lexer);
 
         RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
 
-        if (token_is_of_type(T_K_ASC, lexer_peek(lexer)) || token_is_of_type(T_K_DESC, lexer_peek(lexer))) {
-            lexer_consume(lexer);
+        if (lexer_peek_type(lexer) == T_K_ASC || lexer_peek_type(lexer) == T_K_DESC) {
+            lexer_skip(lexer);
         }
     }
 
@@ -1021,12 +1634,12 @@ static tsqlp_parse_status parse_group_by_inner(struct lexer *lexer, struct tsqlp
 
 static tsqlp_parse_status
 parse_group_by(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    if (token_is_of_type(T_K_GROUP, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    if (lexer_peek_type(lexer) == T_K_GROUP) {
+        lexer_skip(lexer);
 
         RETURN_ERROR_IF_TOKEN_NOT(T_K_BY, lexer);
 
-        TRACK_SECTION(group_by, lexer, parse_result, parse_state, parse_group_by_inner(lexer, parse_result, parse_state));
+        TRACK_SECTION(group_by, TSQLP_SECTION_GROUP_BY, lexer, parse_result, parse_state, parse_group_by_inner(lexer, parse_result, parse_state));
     }
 
     return TSQLP_PARSE_OK;
@@ -1034,10 +1647,10 @@ parse_group_by(struct lexer *lexer, struct tsqlp_parse_result *parse_result, str
 
 static tsqlp_parse_status
 parse_having(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    if (token_is_of_type(T_K_HAVING, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    if (lexer_peek_type(lexer) == T_K_HAVING) {
+        lexer_skip(lexer);
 
-        TRACK_SECTION(having, lexer, parse_result, parse_state, parse_expression(lexer, parse_result, parse_state));
+        TRACK_SECTION(having, TSQLP_SECTION_HAVING, lexer, parse_result, parse_state, parse_expression(lexer, parse_result, parse_state));
     }
 
     return TSQLP_PARSE_OK;
@@ -1047,17 +1660,17 @@ parse_having(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struc
 static tsqlp_parse_status parse_order_by_inner(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
     RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
 
-    if (token_is_of_type(T_K_ASC, lexer_peek(lexer)) || token_is_of_type(T_K_DESC, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    if (lexer_peek_type(lexer) == T_K_ASC || lexer_peek_type(lexer) == T_K_DESC) {
+        lexer_skip(lexer);
     }
 
-    while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    while (lexer_peek_type(lexer) == T_COMMA) {
+        lexer_skip(lexer);
 
         RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
 
-        if (token_is_of_type(T_K_ASC, lexer_peek(lexer)) || token_is_of_type(T_K_DESC, lexer_peek(lexer))) {
-            lexer_consume(lexer);
+        if (lexer_peek_type(lexer) == T_K_ASC || lexer_peek_type(lexer) == T_K_DESC) {
+            lexer_skip(lexer);
         }
     }
 
@@ -1066,42 +1679,43 @@ static tsqlp_parse_status parse_order_by_inner(struct lexer *lexer, struct tsqlp
 
 static tsqlp_parse_status
 parse_order_by(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    if (token_is_of_type(T_K_ORDER, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    if (lexer_peek_type(lexer) == T_K_ORDER) {
+        lexer_skip(lexer);
 
         RETURN_ERROR_IF_TOKEN_NOT(T_K_BY, lexer);
 
-        TRACK_SECTION(order_by, lexer, parse_result, parse_state, parse_order_by_inner(lexer, parse_result, parse_state));
+        TRACK_SECTION(order_by, TSQLP_SECTION_ORDER_BY, lexer, parse_result, parse_state, parse_order_by_inner(lexer, parse_result, parse_state));
     }
 
     return TSQLP_PARSE_OK;
 }
 
-static tsqlp_parse_status parse_limit_inner(struct lexer *lexer, struct parse_state *parse_state) {
-    if (!token_is_of_type(T_NUMBER, lexer_peek(lexer)) && !token_is_of_type(T_PLACEHOLDER, lexer_peek(lexer))) {
+// Row count or offset of LIMIT
+static tsqlp_parse_status parse_limit_value(struct lexer *lexer, struct parse_state *parse_state) {
+    if (lexer_peek_type(lexer) != T_NUMBER && lexer_peek_type(lexer) != T_PLACEHOLDER) {
         return TSQLP_PARSE_INVALID_SYNTAX;
     }
 
-    if (token_is_of_type(T_PLACEHOLDER, lexer_peek(lexer))) {
-        parse_state_register_placeholder(parse_state, token_position(lexer_peek(lexer)));
+    struct token token = lexer_consume(lexer);
+
+    if (token_is_of_type(T_PLACEHOLDER, &token)) {
+        return parse_state_register_placeholder(parse_state, &token);
     }
 
-    lexer_consume(lexer);
+    parse_state_ast_leaf(parse_state, TSQLP_AST_LITERAL, &token);
 
-    if (token_is_of_type(T_NUMBER, lexer_peek(lexer)) || token_is_of_type(T_PLACEHOLDER, lexer_peek(lexer))) {
-        lexer_consume(lexer);
-    } else if (token_is_of_type(T_K_OFFSET, lexer_peek(lexer)) || token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    return parse_state_emit_token(parse_state, TSQLP_EVENT_LITERAL, &token);
+}
 
-        if (!token_is_of_type(T_NUMBER, lexer_peek(lexer)) && !token_is_of_type(T_PLACEHOLDER, lexer_peek(lexer))) {
-            return TSQLP_PARSE_INVALID_SYNTAX;
-        }
+static tsqlp_parse_status parse_limit_inner(struct lexer *lexer, struct parse_state *parse_state) {
+    RETURN_IF_NOT_OK(parse_limit_value(lexer, parse_state));
 
-        if (token_is_of_type(T_PLACEHOLDER, lexer_peek(lexer))) {
-            parse_state_register_placeholder(parse_state, token_position(lexer_peek(lexer)));
-        }
+    if (lexer_peek_type(lexer) == T_NUMBER || lexer_peek_type(lexer) == T_PLACEHOLDER) {
+        lexer_skip(lexer);
+    } else if (lexer_peek_type(lexer) == T_K_OFFSET || lexer_peek_type(lexer) == T_COMMA) {
+        lexer_skip(lexer);
 
-        lexer_consume(lexer);
+        RETURN_IF_NOT_OK(parse_limit_value(lexer, parse_state));
     }
 
     return TSQLP_PARSE_OK;
@@ -1109,10 +1723,10 @@ static tsqlp_parse_status parse_limit_inner(struct lexer *lexer, struct parse_st
 
 static tsqlp_parse_status
 parse_limit(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    if (token_is_of_type(T_K_LIMIT, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    if (lexer_peek_type(lexer) == T_K_LIMIT) {
+        lexer_skip(lexer);
 
-        TRACK_SECTION(limit, lexer, parse_result, parse_state, parse_limit_inner(lexer, parse_state));
+        TRACK_SECTION(limit, TSQLP_SECTION_LIMIT, lexer, parse_result, parse_state, parse_limit_inner(lexer, parse_state));
     }
 
     return TSQLP_PARSE_OK;
@@ -1123,11 +1737,11 @@ parse_procedure_inner(struct lexer *lexer, struct tsqlp_parse_result *parse_resu
     RETURN_ERROR_IF_TOKEN_NOT(T_IDENTIFIER, lexer);
     RETURN_ERROR_IF_TOKEN_NOT(T_OPEN_PAREN, lexer);
 
-    if (!token_is_of_type(T_CLOSE_PAREN, lexer_peek(lexer))) {
+    if (lexer_peek_type(lexer) != T_CLOSE_PAREN) {
         RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
 
-        while (token_is_of_type(T_COMMA, lexer_peek(lexer))) {
-            lexer_consume(lexer);
+        while (lexer_peek_type(lexer) == T_COMMA) {
+            lexer_skip(lexer);
 
             RETURN_IF_NOT_OK(parse_expression(lexer, parse_result, parse_state));
         }
@@ -1140,10 +1754,10 @@ parse_procedure_inner(struct lexer *lexer, struct tsqlp_parse_result *parse_resu
 
 static tsqlp_parse_status
 parse_procedure(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    if (token_is_of_type(T_K_PROCEDURE, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    if (lexer_peek_type(lexer) == T_K_PROCEDURE) {
+        lexer_skip(lexer);
 
-        TRACK_SECTION(procedure, lexer, parse_result, parse_state,
+        TRACK_SECTION(procedure, TSQLP_SECTION_PROCEDURE, lexer, parse_result, parse_state,
                       parse_procedure_inner(lexer, parse_result, parse_state));
     }
 
@@ -1152,16 +1766,16 @@ parse_procedure(struct lexer *lexer, struct tsqlp_parse_result *parse_result, st
 
 static tsqlp_parse_status
 parse_second_into(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    TRACK_SECTION(second_into, lexer, parse_result, parse_state, parse_first_into_inner(lexer));
+    TRACK_SECTION(second_into, TSQLP_SECTION_SECOND_INTO, lexer, parse_result, parse_state, parse_first_into_inner(lexer));
 }
 
 static tsqlp_parse_status parse_flags_inner(struct lexer *lexer) {
-    if (token_is_of_type(T_K_FOR, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    if (lexer_peek_type(lexer) == T_K_FOR) {
+        lexer_skip(lexer);
 
         RETURN_ERROR_IF_TOKEN_NOT(T_K_UPDATE, lexer);
-    } else if (token_is_of_type(T_K_LOCK, lexer_peek(lexer))) {
-        lexer_consume(lexer);
+    } else if (lexer_peek_type(lexer) == T_K_LOCK) {
+        lexer_skip(lexer);
 
         RETURN_ERROR_IF_TOKEN_NOT(T_K_IN, lexer);
         RETURN_ERROR_IF_TOKEN_NOT(T_K_SHARE, lexer);
@@ -1173,29 +1787,170 @@ static tsqlp_parse_status parse_flags_inner(struct lexer *lexer) {
 
 static tsqlp_parse_status
 parse_flags(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
-    TRACK_SECTION(flags, lexer, parse_result, parse_state, parse_flags_inner(lexer));
+    TRACK_SECTION(flags, TSQLP_SECTION_FLAGS, lexer, parse_result, parse_state, parse_flags_inner(lexer));
 }
 
+/*
+ * The top level statement is the only one parsed at depth 1. It stops once every requested section is done, subqueries
+ * always parse all their sections.
+ */
+#define PARSE_SECTION(flag, parse_state, call) \
+    do { \
+        if ((parse_state)->depth == 1 && (parse_state)->sections_pending == 0) { \
+            (parse_state)->has_stopped_early = 1; \
+            \
+            return TSQLP_PARSE_OK; \
+        } \
+        \
+        RETURN_IF_NOT_OK(call); \
+        \
+        if ((parse_state)->depth == 1) { \
+            (parse_state)->sections_pending &= ~(unsigned int) (flag); \
+        } \
+    } while (0)
+
 static tsqlp_parse_status
-parse_stmt(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
+parse_stmt_sections(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
     RETURN_ERROR_IF_TOKEN_NOT(T_K_SELECT, lexer);
 
-    RETURN_IF_NOT_OK(parse_modifiers(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_columns(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_first_into(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_tables(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_where(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_group_by(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_having(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_order_by(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_limit(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_procedure(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_second_into(lexer, parse_result, parse_state));
-    RETURN_IF_NOT_OK(parse_flags(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_MODIFIERS, parse_state, parse_modifiers(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_COLUMNS, parse_state, parse_columns(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_FIRST_INTO, parse_state, parse_first_into(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_TABLES, parse_state, parse_tables(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_WHERE, parse_state, parse_where(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_GROUP_BY, parse_state, parse_group_by(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_HAVING, parse_state, parse_having(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_ORDER_BY, parse_state, parse_order_by(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_LIMIT, parse_state, parse_limit(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_PROCEDURE, parse_state, parse_procedure(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_SECOND_INTO, parse_state, parse_second_into(lexer, parse_result, parse_state));
+    PARSE_SECTION(TSQLP_SECTION_FLAGS, parse_state, parse_flags(lexer, parse_result, parse_state));
+
+    return TSQLP_PARSE_OK;
+}
+
+static tsqlp_parse_status
+parse_stmt_inner(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
+    size_t offset = parse_state_ast_offset(parse_state, lexer);
+    size_t ast_mark = parse_state_ast_mark(parse_state);
+
+    RETURN_IF_NOT_OK(parse_stmt_sections(lexer, parse_result, parse_state));
+
+    parse_state_ast_close(parse_state, lexer, TSQLP_AST_STATEMENT, offset, ast_mark);
+
+    return TSQLP_PARSE_OK;
+}
+
+static void parse_result_clear(struct tsqlp_parse_result *parse_result);
+
+#define SUBQUERIES_INITIAL_CAPACITY 4
+
+/*
+ * Capacity is not stored, it is the power of two, at least SUBQUERIES_INITIAL_CAPACITY, which fits count
+ */
+static void parse_result_add_subquery(struct tsqlp_parse_result *parse_result, struct tsqlp_subquery subquery,
+                                      struct tsqlp_arena *arena) {
+    struct tsqlp_subqueries *subqueries = &parse_result->subqueries;
+
+    if (
+        subqueries->count == 0
+        || (subqueries->count >= SUBQUERIES_INITIAL_CAPACITY && (subqueries->count & (subqueries->count - 1)) == 0)
+        ) {
+        size_t capacity = subqueries->count > 0 ? subqueries->count * 2 : SUBQUERIES_INITIAL_CAPACITY;
+
+        subqueries->items = (struct tsqlp_subquery *) tsqlp_arena_grow(
+            arena,
+            subqueries->items,
+            subqueries->count * sizeof(struct tsqlp_subquery),
+            capacity * sizeof(struct tsqlp_subquery)
+        );
+    }
+
+    subqueries->items[subqueries->count++] = subquery;
+}
+
+/*
+ * Statement nested in a section of the enclosing one, parsed into a result of its own which is added to the
+ * subqueries of the enclosing result. Placeholder tracking of the enclosing statement is put aside meanwhile, so the
+ * subquery tracks its own sections.
+ */
+static tsqlp_parse_status
+parse_subquery(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
+    struct tsqlp_parse_result *subquery_result = (struct tsqlp_parse_result *) tsqlp_arena_alloc(
+        parse_state->arena,
+        sizeof(struct tsqlp_parse_result)
+    );
+    size_t offset = lexer_peek_position(lexer);
+    size_t section_start = parse_state->section_start;
+    size_t section_offset = parse_state->section_offset;
+
+    parse_result_clear(subquery_result);
+    parse_state->is_tracking_in_progress = 0;
+
+    tsqlp_parse_status subquery_status = parse_stmt_inner(lexer, subquery_result, parse_state);
+
+    parse_state->is_tracking_in_progress = 1;
+    parse_state->section_start = section_start;
+    parse_state->section_offset = section_offset;
+
+    RETURN_IF_NOT_OK(subquery_status);
+
+    parse_result_add_subquery(parse_result, (struct tsqlp_subquery) {
+        .offset = offset,
+        .len = lexer_previous_end(lexer) - offset,
+        .parse_result = subquery_result
+    }, parse_state->arena);
 
     return TSQLP_PARSE_OK;
 }
 
+/*
+ * Statement of tsqlp_parse_events(), reported as a subquery unless it is the top level one
+ */
+static tsqlp_parse_status
+parse_stmt_events(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
+    size_t offset = lexer_peek_position(lexer);
+    int is_subquery = parse_state->statements > 0;
+
+    if (is_subquery) {
+        RETURN_IF_NOT_OK(parse_state_emit(parse_state, TSQLP_EVENT_SUBQUERY_START, (struct tsqlp_token) {
+            .type = TSQLP_TOKEN_UNKNOWN,
+            .offset = offset,
+            .len = 0
+        }));
+    }
+
+    parse_state->statements++;
+    tsqlp_parse_status statement_status = parse_stmt_inner(lexer, parse_result, parse_state);
+    parse_state->statements--;
+
+    RETURN_IF_NOT_OK(statement_status);
+
+    if (!is_subquery) {
+        return TSQLP_PARSE_OK;
+    }
+
+    return parse_state_emit(parse_state, TSQLP_EVENT_SUBQUERY_END, (struct tsqlp_token) {
+        .type = TSQLP_TOKEN_UNKNOWN,
+        .offset = offset,
+        .len = lexer_previous_end(lexer) - offset
+    });
+}
+
+static tsqlp_parse_status
+parse_stmt(struct lexer *lexer, struct tsqlp_parse_result *parse_result, struct parse_state *parse_state) {
+    // Any statement starting inside a section is a subquery
+    if (parse_state->is_tracking_in_progress) {
+        PARSE_NESTED(parse_state, parse_subquery(lexer, parse_result, parse_state));
+    }
+
+    if (parse_state->callback != NULL) {
+        PARSE_NESTED(parse_state, parse_stmt_events(lexer, parse_result, parse_state));
+    }
+
+    PARSE_NESTED(parse_state, parse_stmt_inner(lexer, parse_result, parse_state));
+}
+
 struct tsqlp_placeholders tsqlp_placeholders_new() {
     return (struct tsqlp_placeholders) {
         .locations = NULL,
@@ -1203,9 +1958,10 @@ struct tsqlp_placeholders tsqlp_placeholders_new() {
     };
 }
 
-void tsqlp_placeholders_push(struct tsqlp_placeholders *placeholders, size_t location) {
-    placeholders->locations = (size_t *) realloc_panic(placeholders->locations,
-                                                       (placeholders->count + 1) * sizeof(size_t));
+void tsqlp_placeholders_push(struct tsqlp_placeholders *placeholders, size_t location, struct tsqlp_arena *arena) {
+    placeholders->locations = (size_t *) tsqlp_arena_grow(arena, placeholders->locations,
+                                                          placeholders->count * sizeof(size_t),
+                                                          (placeholders->count + 1) * sizeof(size_t));
     placeholders->locations[placeholders->count++] = location;
 }
 
@@ -1221,12 +1977,6 @@ size_t tsqlp_placeholders_position_at(const struct tsqlp_placeholders *placehold
     return 0;
 }
 
-void tsqlp_placeholders_destroy(struct tsqlp_placeholders *placeholders) {
-    if (placeholders->locations != NULL) {
-        free(placeholders->locations);
-    }
-}
-
 struct tsqlp_sql_section tsqlp_sql_section_new() {
     return (struct tsqlp_sql_section) {
         .chunk = NULL,
@@ -1254,11 +2004,11 @@ struct tsqlp_placeholders *tsqlp_sql_section_placeholders(struct tsqlp_sql_secti
     return &sql_section->placeholders;
 }
 
-void
-tsqlp_sql_section_update(const char *chunk, size_t len, struct tsqlp_placeholders placeholders, struct tsqlp_sql_section *sql_section) {
+void tsqlp_sql_section_update(const char *chunk, size_t len, struct tsqlp_placeholders placeholders,
+                              struct tsqlp_sql_section *sql_section, struct tsqlp_arena *arena) {
 
     // @todo: remove +1 and null character when tests don't print using %s
-    char *buff = (char *) malloc_panic(sizeof(char) * (len + 1));
+    char *buff = (char *) tsqlp_arena_alloc(arena, sizeof(char) * (len + 1));
     buff[len] = '\0';
 
     memcpy(buff, chunk, len);
@@ -1271,14 +2021,91 @@ tsqlp_sql_section_update(const char *chunk, size_t len, struct tsqlp_placeholder
 
 }
 
-void tsqlp_sql_section_destroy(struct tsqlp_sql_section *sql_section) {
-    if (sql_section->chunk == NULL) {
-        return;
+void tsqlp_sql_section_view(const char *chunk, size_t len, struct tsqlp_placeholders placeholders,
+                            struct tsqlp_sql_section *sql_section) {
+    *sql_section = (struct tsqlp_sql_section) {
+        .chunk = chunk,
+        .len = len,
+        .placeholders = placeholders
+    };
+}
+
+struct tsqlp_hints tsqlp_hints_new() {
+    return (struct tsqlp_hints) {
+        .locations = NULL,
+        .lengths = NULL,
+        .count = 0
+    };
+}
+
+int tsqlp_hints_count(const struct tsqlp_hints *hints) {
+    return hints->count;
+}
+
+size_t tsqlp_hints_position_at(const struct tsqlp_hints *hints, unsigned int index) {
+    if (index < hints->count) {
+        return hints->locations[index];
+    }
+
+    return 0;
+}
+
+size_t tsqlp_hints_length_at(const struct tsqlp_hints *hints, unsigned int index) {
+    if (index < hints->count) {
+        return hints->lengths[index];
     }
 
-    free(sql_section->chunk);
+    return 0;
+}
+
+struct tsqlp_hints *tsqlp_parse_result_hints(struct tsqlp_parse_result *parse_result) {
+    return &parse_result->hints;
+}
+
+struct tsqlp_subqueries tsqlp_subqueries_new() {
+    return (struct tsqlp_subqueries) {
+        .items = NULL,
+        .count = 0
+    };
+}
+
+struct tsqlp_subqueries *tsqlp_parse_result_subqueries(struct tsqlp_parse_result *parse_result) {
+    return &parse_result->subqueries;
+}
+
+int tsqlp_subqueries_count(const struct tsqlp_subqueries *subqueries) {
+    return subqueries->count;
+}
+
+struct tsqlp_subquery *tsqlp_subqueries_at(const struct tsqlp_subqueries *subqueries, unsigned int index) {
+    if (index < subqueries->count) {
+        return &subqueries->items[index];
+    }
+
+    return NULL;
+}
+
+struct tsqlp_ast tsqlp_ast_new() {
+    return (struct tsqlp_ast) {
+        .nodes = NULL,
+        .count = 0
+    };
+}
+
+struct tsqlp_ast *tsqlp_parse_result_ast(struct tsqlp_parse_result *parse_result) {
+    return &parse_result->ast;
+}
 
-    tsqlp_placeholders_destroy(&sql_section->placeholders);
+int tsqlp_ast_count(const struct tsqlp_ast *ast) {
+    return ast->count;
+}
+
+struct tsqlp_ast_node *tsqlp_ast_at(const struct tsqlp_ast *ast, unsigned int index) {
+    if (index < ast->count) {
+        return &ast->nodes[index];
+    }
+
+    return NULL;
 }
 
 void tsqlp_parse_result_serialize(struct tsqlp_parse_result *parse_result, FILE *file) {
@@ -1312,6 +2139,18 @@ void tsqlp_parse_result_serialize(struct tsqlp_parse_result *parse_result, FILE
     PRINT_SECTION(procedure);
     PRINT_SECTION(second_into);
     PRINT_SECTION(flags);
+
+    size_t hints_count = tsqlp_hints_count(&parse_result->hints);
+
+    if (hints_count > 0) {
+        fprintf(file, "hints %ld ", hints_count);
+
+        for (size_t i = 0; i < hints_count; i++) {
+            fprintf(file, "%ld %ld ", tsqlp_hints_position_at(&parse_result->hints, i), tsqlp_hints_length_at(&parse_result->hints, i));
+        }
+
+        fprintf(file, "\n");
+    }
 }
 
 #define SHUTDOWN() exit(2)
@@ -1336,15 +2175,244 @@ void *realloc_panic(void *ptr, size_t size) {
     return ptr;
 }
 
+/*
+ * Parse result shares its allocation with the arena holding section chunks, placeholders and hints, and with the
+ * first arena block, so a parse fitting the first block does not allocate anything else for its result
+ */
+struct parse_result_storage {
+    struct tsqlp_parse_result parse_result;
+    // Sections point into the parsed statement instead of holding a copy
+    int use_views;
+    unsigned int max_depth;
+    unsigned int sections;
+    // Sections are found by tsqlp_shallow_scan() when the grammar rejects the statement
+    int has_shallow_fallback;
+    // Successful parses also build the AST of the statement
+    int has_ast;
+    // Set when the last parse failed with TSQLP_PARSE_INVALID_SYNTAX
+    int has_syntax_error;
+    struct tsqlp_syntax_error syntax_error;
+    struct tsqlp_arena arena;
+    struct tsqlp_arena_block first_block;
+};
+
+#define PARSE_RESULT_FIRST_BLOCK_SIZE 1024
+
+struct tsqlp_arena *tsqlp_parse_result_arena(struct tsqlp_parse_result *parse_result) {
+    return &((struct parse_result_storage *) parse_result)->arena;
+}
+
+static int parse_result_uses_views(struct tsqlp_parse_result *parse_result) {
+    return ((struct parse_result_storage *) parse_result)->use_views;
+}
+
+static unsigned int parse_result_max_depth(struct tsqlp_parse_result *parse_result) {
+    return ((struct parse_result_storage *) parse_result)->max_depth;
+}
+
+static unsigned int parse_result_sections(struct tsqlp_parse_result *parse_result) {
+    return ((struct parse_result_storage *) parse_result)->sections;
+}
+
+static void parse_result_clear(struct tsqlp_parse_result *parse_result) {
+    parse_result->modifiers = tsqlp_sql_section_new();
+    parse_result->columns = tsqlp_sql_section_new();
+    parse_result->first_into = tsqlp_sql_section_new();
+    parse_result->tables = tsqlp_sql_section_new();
+    parse_result->where = tsqlp_sql_section_new();
+    parse_result->group_by = tsqlp_sql_section_new();
+    parse_result->having = tsqlp_sql_section_new();
+    parse_result->order_by = tsqlp_sql_section_new();
+    parse_result->limit = tsqlp_sql_section_new();
+    parse_result->procedure = tsqlp_sql_section_new();
+    parse_result->second_into = tsqlp_sql_section_new();
+    parse_result->flags = tsqlp_sql_section_new();
+    parse_result->hints = tsqlp_hints_new();
+    parse_result->subqueries = tsqlp_subqueries_new();
+    parse_result->ast = tsqlp_ast_new();
+}
+
+static void parse_result_storage_init(struct parse_result_storage *storage, size_t first_block_size) {
+    storage->use_views = 0;
+    storage->max_depth = TSQLP_DEFAULT_MAX_DEPTH;
+    storage->sections = TSQLP_SECTION_ALL;
+    storage->has_shallow_fallback = 0;
+    storage->has_ast = 0;
+    storage->has_syntax_error = 0;
+    tsqlp_arena_init(&storage->arena, &storage->first_block, first_block_size);
+    parse_result_clear(&storage->parse_result);
+}
+
+static void
+parse_result_copy_hints(struct tsqlp_parse_result *parse_result, const struct lexer *lexer, struct tsqlp_arena *arena) {
+    const struct lexer_hints *hints = lexer_hints(lexer);
+
+    parse_result->hints = tsqlp_hints_new();
+
+    if (hints->count > 0) {
+        parse_result->hints = (struct tsqlp_hints) {
+            .locations = (size_t *) tsqlp_arena_alloc(arena, hints->count * sizeof(size_t)),
+            .lengths = (size_t *) tsqlp_arena_alloc(arena, hints->count * sizeof(size_t)),
+            .count = hints->count
+        };
+
+        memcpy(parse_result->hints.locations, hints->positions, hints->count * sizeof(size_t));
+        memcpy(parse_result->hints.lengths, hints->lengths, hints->count * sizeof(size_t));
+    }
+}
+
+/*
+ * Parses with a lexer, and with TSQLP_STRUCTURAL_INDEX an index in parse_state, already set up for the statement
+ */
+static tsqlp_parse_status
+parse_with(struct lexer *lexer, struct parse_state *parse_state, struct tsqlp_parse_result *parse_result) {
+    parse_state->has_ast = ((struct parse_result_storage *) parse_result)->has_ast;
+
+    tsqlp_parse_status status = parse_stmt(lexer, parse_result, parse_state);
+
+    if (status == TSQLP_PARSE_OK && !parse_state->has_stopped_early && lexer_has(lexer)) {
+        status = TSQLP_PARSE_INVALID_SYNTAX;
+    }
+
+    if (status == TSQLP_PARSE_OK && parse_state->has_ast) {
+        parse_result->ast = parse_state_ast_finish(parse_state);
+    }
+
+    if (status == TSQLP_PARSE_INVALID_SYNTAX) {
+        struct parse_result_storage *storage = (struct parse_result_storage *) parse_result;
+        const struct token *token = lexer_peek(lexer);
+
+        storage->has_syntax_error = 1;
+        storage->syntax_error = (struct tsqlp_syntax_error) {
+            .token = {
+                .type = tsqlp_token_type_from(token_type(token)),
+                .offset = token_position(token),
+                .len = token_length(token)
+            },
+            .expected = tsqlp_token_type_from(lexer_expected(lexer))
+        };
+
+        if (storage->has_shallow_fallback) {
+            // The statement is scanned again from its start, into a result without the sections parsed so far
+            lexer_reset(lexer, lexer_buffer(lexer), lexer_buffer_length(lexer));
+            parse_result_clear(parse_result);
+
+            if (
+                tsqlp_shallow_scan(lexer, parse_result, parse_state->arena, parse_state->use_views,
+                                   parse_state->sections) == TSQLP_PARSE_OK
+                ) {
+                status = TSQLP_PARSE_SHALLOW;
+            } else {
+                parse_result_clear(parse_result);
+            }
+        }
+    }
+
+    parse_result_copy_hints(parse_result, lexer, parse_state->arena);
+
+    return status;
+}
+
+/*
+ * Parses the valid UTF-8 statement of the lexer with the settings and the arena of the result
+ */
+static tsqlp_parse_status parse_lexed(struct lexer *lexer, struct tsqlp_parse_result *parse_result) {
+    struct parse_state parse_state = parse_state_new(
+        tsqlp_parse_result_arena(parse_result),
+        parse_result_uses_views(parse_result),
+        parse_result_max_depth(parse_result),
+        parse_result_sections(parse_result)
+    );
+
+#ifdef TSQLP_STRUCTURAL_INDEX
+    struct structural_index structural_index = structural_index_new(lexer_buffer(lexer), lexer_buffer_length(lexer));
+
+    parse_state.structural_index = &structural_index;
+#endif
+
+    tsqlp_parse_status status = parse_with(lexer, &parse_state, parse_result);
+
+#ifdef TSQLP_STRUCTURAL_INDEX
+    structural_index_destroy(&structural_index);
+#endif
+
+    return status;
+}
+
 tsqlp_parse_status tsqlp_parse(const char *sql, size_t len, struct tsqlp_parse_result *parse_result) {
     if (sql == NULL) {
         return TSQLP_PARSE_ERROR_INVALID_ARGUMENT;
     }
 
+    // A reused result starts over, without the sections and the arena contents of the previous statement
+    tsqlp_arena_reset(tsqlp_parse_result_arena(parse_result));
+    parse_result_clear(parse_result);
+    ((struct parse_result_storage *) parse_result)->has_syntax_error = 0;
+
+    if (!utf8_is_valid(sql, len)) {
+        return TSQLP_PARSE_INVALID_UTF8;
+    }
+
+    struct lexer lexer = lexer_new(sql, len);
+    tsqlp_parse_status status = parse_lexed(&lexer, parse_result);
+
+    lexer_destroy(&lexer);
+
+    return status;
+}
+
+tsqlp_parse_status tsqlp_parse_shallow(const char *sql, size_t len, struct tsqlp_parse_result *parse_result) {
+    if (sql == NULL) {
+        return TSQLP_PARSE_ERROR_INVALID_ARGUMENT;
+    }
+
+    tsqlp_arena_reset(tsqlp_parse_result_arena(parse_result));
+    parse_result_clear(parse_result);
+    ((struct parse_result_storage *) parse_result)->has_syntax_error = 0;
+
+    if (!utf8_is_valid(sql, len)) {
+        return TSQLP_PARSE_INVALID_UTF8;
+    }
+
+    struct tsqlp_arena *arena = tsqlp_parse_result_arena(parse_result);
     struct lexer lexer = lexer_new(sql, len);
-    struct parse_state parse_state = parse_state_new();
+    tsqlp_parse_status status = tsqlp_shallow_scan(
+        &lexer,
+        parse_result,
+        arena,
+        parse_result_uses_views(parse_result),
+        parse_result_sections(parse_result)
+    );
+
+    parse_result_copy_hints(parse_result, &lexer, arena);
+    lexer_destroy(&lexer);
+
+    return status;
+}
+
+/*
+ * Parses a whole statement for the callers which do not fill a result. No section is tracked, so nothing is copied and
+ * neither the arena nor a structural index is needed.
+ */
+static tsqlp_parse_status parse_untracked(const char *sql, size_t len, struct parse_state *parse_state) {
+    if (sql == NULL) {
+        return TSQLP_PARSE_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!utf8_is_valid(sql, len)) {
+        return TSQLP_PARSE_INVALID_UTF8;
+    }
+
+    struct lexer lexer;
+    struct tsqlp_parse_result parse_result;
+
+    lexer_init_static(&lexer, sql, len);
+    parse_result_clear(&parse_result);
+
+    // Every section is still pending, which keeps the top level statement from stopping early
+    parse_state->sections_pending = TSQLP_SECTION_ALL;
 
-    tsqlp_parse_status status = parse_stmt(&lexer, parse_result, &parse_state);
+    tsqlp_parse_status status = parse_stmt(&lexer, &parse_result, parse_state);
 
     if (status == TSQLP_PARSE_OK && lexer_has(&lexer)) {
         status = TSQLP_PARSE_INVALID_SYNTAX;
@@ -1355,48 +2423,285 @@ tsqlp_parse_status tsqlp_parse(const char *sql, size_t len, struct tsqlp_parse_r
     return status;
 }
 
+tsqlp_parse_status tsqlp_validate(const char *sql, size_t len, size_t *placeholder_count) {
+    struct parse_state parse_state = parse_state_new(NULL, 0, TSQLP_DEFAULT_MAX_DEPTH, 0);
+    tsqlp_parse_status status = parse_untracked(sql, len, &parse_state);
+
+    if (placeholder_count != NULL) {
+        *placeholder_count = status == TSQLP_PARSE_OK ? parse_state.placeholder_count : 0;
+    }
+
+    return status;
+}
+
+tsqlp_parse_status
+tsqlp_parse_events(const char *sql, size_t len, tsqlp_event_callback callback, void *user_data) {
+    if (callback == NULL) {
+        return TSQLP_PARSE_ERROR_INVALID_ARGUMENT;
+    }
+
+    struct parse_state parse_state = parse_state_new(NULL, 0, TSQLP_DEFAULT_MAX_DEPTH, 0);
+
+    parse_state.callback = callback;
+    parse_state.user_data = user_data;
+
+    return parse_untracked(sql, len, &parse_state);
+}
+
+tsqlp_parse_status tsqlp_parse_into(const char *sql, size_t len, void *buf, size_t cap,
+                                    struct tsqlp_parse_result **parse_result, size_t *required) {
+    if (sql == NULL || parse_result == NULL || required == NULL || (buf == NULL && cap > 0)) {
+        return TSQLP_PARSE_ERROR_INVALID_ARGUMENT;
+    }
+
+    *parse_result = NULL;
+    *required = 0;
+
+    if (!utf8_is_valid(sql, len)) {
+        return TSQLP_PARSE_INVALID_UTF8;
+    }
+
+    size_t padding = (size_t) (-(uintptr_t) buf & (TSQLP_ARENA_ALIGNMENT - 1));
+    // Takes the result when not even that fits buf, so the statement can still be measured
+    struct parse_result_storage fallback_storage;
+    struct parse_result_storage *storage = &fallback_storage;
+    size_t first_block_size = 0;
+
+    if (cap >= padding + sizeof(struct parse_result_storage)) {
+        storage = (struct parse_result_storage *) ((char *) buf + padding);
+        first_block_size = cap - padding - sizeof(struct parse_result_storage);
+    }
+
+    parse_result_storage_init(storage, first_block_size);
+
+    struct lexer lexer;
+
+    lexer_init_static(&lexer, sql, len);
+    lexer_collect_hints(&lexer, &storage->arena);
+
+    tsqlp_parse_status status = parse_lexed(&lexer, &storage->parse_result);
+
+    lexer_destroy(&lexer);
+
+    // Padding in front of the result is counted in full, so the size holds for a buffer at any address
+    *required = TSQLP_ARENA_ALIGNMENT - 1 + sizeof(struct parse_result_storage)
+                + tsqlp_arena_required(&storage->arena);
+
+    if (storage == &fallback_storage || storage->arena.block->previous != NULL) {
+        // Blocks past buf only measured the statement, nothing may point into them once they are freed
+        parse_result_clear(&storage->parse_result);
+        tsqlp_arena_destroy(&storage->arena);
+
+        if (storage == &fallback_storage || status == TSQLP_PARSE_OK) {
+            return TSQLP_PARSE_BUFFER_TOO_SMALL;
+        }
+    }
+
+    *parse_result = &storage->parse_result;
+
+    return status;
+}
+
+size_t tsqlp_parse_into_bound(size_t len) {
+    // Every allocation may lose that much to alignment
+    size_t padding = TSQLP_ARENA_ALIGNMENT - 1;
+    // Every subquery takes at least its "(SELECT"
+    size_t subqueries = len / 7;
+    size_t levels = subqueries < TSQLP_DEFAULT_MAX_DEPTH ? subqueries : TSQLP_DEFAULT_MAX_DEPTH;
+    /*
+     * Bytes of the statement copied once for every statement holding them in a section. Statements nested k levels
+     * deep leave at least 7 * k bytes to the enclosing ones, and at most every other byte of them is a placeholder,
+     * whose location is copied again for each subquery holding it.
+     */
+    size_t nested = (levels + 1) * len - 7 * levels * (levels + 1) / 2;
+    size_t copies = nested + sizeof(size_t) * (nested - len + levels) / 2;
+    /*
+     * Other than that a byte is used by one of these at most, so only the most expensive use is counted for all of
+     * them. A subquery takes its result, its entry in the doubling subquery list of the enclosing statement and the NUL
+     * and padding of a section, every other section needs a keyword of at least 3 bytes. Placeholders take a separator
+     * and their doubling pool entry. Hints take at least 5 bytes, two doubling lists while lexing and two copies.
+     */
+    size_t section = 1 + 2 * padding;
+    size_t subquery = sizeof(struct tsqlp_parse_result) + 4 * sizeof(struct tsqlp_subquery) + 2 * padding + section;
+    size_t placeholder = 4 * sizeof(size_t) + 1;
+    size_t hint = 10 * sizeof(size_t) + 4 * padding;
+    size_t uses = subquery * subqueries;
+
+    uses = section * (len / 3) > uses ? section * (len / 3) : uses;
+    uses = placeholder * (len / 2) > uses ? placeholder * (len / 2) : uses;
+    uses = hint * (len / 5) > uses ? hint * (len / 5) : uses;
+
+    // The first section of the top level statement, rounding of the uses and the pool, which starts with 16 entries
+    return padding + sizeof(struct parse_result_storage) + copies + uses + section + subquery + placeholder + hint
+           + 16 * sizeof(size_t) + padding;
+}
+
 struct tsqlp_parse_result *tsqlp_parse_result_new() {
-    struct tsqlp_parse_result *parse_result = (struct tsqlp_parse_result *) malloc(sizeof(struct tsqlp_parse_result));
+    struct parse_result_storage *storage = (struct parse_result_storage *) malloc(
+        sizeof(struct parse_result_storage) + PARSE_RESULT_FIRST_BLOCK_SIZE
+    );
 
-    if (parse_result == NULL) {
+    if (storage == NULL) {
         return NULL;
     }
 
-    parse_result->modifiers = tsqlp_sql_section_new();
-    parse_result->columns = tsqlp_sql_section_new();
-    parse_result->first_into = tsqlp_sql_section_new();
-    parse_result->tables = tsqlp_sql_section_new();
-    parse_result->where = tsqlp_sql_section_new();
-    parse_result->group_by = tsqlp_sql_section_new();
-    parse_result->having = tsqlp_sql_section_new();
-    parse_result->order_by = tsqlp_sql_section_new();
-    parse_result->limit = tsqlp_sql_section_new();
-    parse_result->procedure = tsqlp_sql_section_new();
-    parse_result->second_into = tsqlp_sql_section_new();
-    parse_result->flags = tsqlp_sql_section_new();
+    parse_result_storage_init(storage, PARSE_RESULT_FIRST_BLOCK_SIZE);
+
+    return &storage->parse_result;
+}
+
+void tsqlp_parse_result_set_max_depth(struct tsqlp_parse_result *parse_result, unsigned int max_depth) {
+    ((struct parse_result_storage *) parse_result)->max_depth = max_depth;
+}
+
+void tsqlp_parse_result_set_sections(struct tsqlp_parse_result *parse_result, unsigned int sections) {
+    ((struct parse_result_storage *) parse_result)->sections = sections & TSQLP_SECTION_ALL;
+}
+
+void tsqlp_parse_result_set_shallow_fallback(struct tsqlp_parse_result *parse_result, int is_enabled) {
+    ((struct parse_result_storage *) parse_result)->has_shallow_fallback = is_enabled;
+}
+
+void tsqlp_parse_result_set_ast(struct tsqlp_parse_result *parse_result, int is_enabled) {
+    ((struct parse_result_storage *) parse_result)->has_ast = is_enabled;
+}
+
+int tsqlp_parse_result_syntax_error(struct tsqlp_parse_result *parse_result, struct tsqlp_syntax_error *syntax_error) {
+    struct parse_result_storage *storage = (struct parse_result_storage *) parse_result;
+
+    if (!storage->has_syntax_error) {
+        return 0;
+    }
+
+    *syntax_error = storage->syntax_error;
+
+    return 1;
+}
+
+struct tsqlp_parse_result *tsqlp_parse_result_new_with_views() {
+    struct tsqlp_parse_result *parse_result = tsqlp_parse_result_new();
+
+    if (parse_result != NULL) {
+        ((struct parse_result_storage *) parse_result)->use_views = 1;
+    }
 
     return parse_result;
 }
 
+/*
+ * Everything a parse sets up, kept between parses so that they stop allocating once the buffers fit the statements
+ */
+struct tsqlp_parser {
+    struct lexer lexer;
+#ifdef TSQLP_STRUCTURAL_INDEX
+    struct structural_index structural_index;
+#endif
+    struct tsqlp_parse_result *parse_result;
+};
+
+static struct tsqlp_parser *parser_new(struct tsqlp_parse_result *parse_result) {
+    if (parse_result == NULL) {
+        return NULL;
+    }
+
+    struct tsqlp_parser *parser = (struct tsqlp_parser *) malloc(sizeof(struct tsqlp_parser));
+
+    if (parser == NULL) {
+        tsqlp_parse_result_free(parse_result);
+
+        return NULL;
+    }
+
+    parser->lexer = lexer_new("", 0);
+#ifdef TSQLP_STRUCTURAL_INDEX
+    parser->structural_index = structural_index_new("", 0);
+#endif
+    parser->parse_result = parse_result;
+
+    return parser;
+}
+
+struct tsqlp_parser *tsqlp_parser_new() {
+    return parser_new(tsqlp_parse_result_new());
+}
+
+struct tsqlp_parser *tsqlp_parser_new_with_views() {
+    return parser_new(tsqlp_parse_result_new_with_views());
+}
+
+tsqlp_parse_status tsqlp_parser_parse(struct tsqlp_parser *parser, const char *sql, size_t len) {
+    struct tsqlp_parse_result *parse_result = parser->parse_result;
+
+    tsqlp_arena_reset(tsqlp_parse_result_arena(parse_result));
+    parse_result_clear(parse_result);
+    ((struct parse_result_storage *) parse_result)->has_syntax_error = 0;
+
+    if (sql == NULL) {
+        return TSQLP_PARSE_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!utf8_is_valid(sql, len)) {
+        return TSQLP_PARSE_INVALID_UTF8;
+    }
+
+    lexer_reset(&parser->lexer, sql, len);
+
+    struct parse_state parse_state = parse_state_new(
+        tsqlp_parse_result_arena(parse_result),
+        parse_result_uses_views(parse_result),
+        parse_result_max_depth(parse_result),
+        parse_result_sections(parse_result)
+    );
+
+#ifdef TSQLP_STRUCTURAL_INDEX
+    structural_index_rebuild(&parser->structural_index, sql, len);
+
+    parse_state.structural_index = &parser->structural_index;
+#endif
+
+    return parse_with(&parser->lexer, &parse_state, parse_result);
+}
+
+void tsqlp_parser_set_max_depth(struct tsqlp_parser *parser, unsigned int max_depth) {
+    tsqlp_parse_result_set_max_depth(parser->parse_result, max_depth);
+}
+
+void tsqlp_parser_set_sections(struct tsqlp_parser *parser, unsigned int sections) {
+    tsqlp_parse_result_set_sections(parser->parse_result, sections);
+}
+
+void tsqlp_parser_set_shallow_fallback(struct tsqlp_parser *parser, int is_enabled) {
+    tsqlp_parse_result_set_shallow_fallback(parser->parse_result, is_enabled);
+}
+
+void tsqlp_parser_set_ast(struct tsqlp_parser *parser, int is_enabled) {
+    tsqlp_parse_result_set_ast(parser->parse_result, is_enabled);
+}
+
+struct tsqlp_parse_result *tsqlp_parser_result(struct tsqlp_parser *parser) {
+    return parser->parse_result;
+}
+
+void tsqlp_parser_free(struct tsqlp_parser *parser) {
+    lexer_destroy(&parser->lexer);
+#ifdef TSQLP_STRUCTURAL_INDEX
+    structural_index_destroy(&parser->structural_index);
+#endif
+    tsqlp_parse_result_free(parser->parse_result);
+
+    free(parser);
+}
+
 unsigned int tsqlp_api_version() {
     return API_VERSION;
 }
 
 void tsqlp_parse_result_free(struct tsqlp_parse_result *parse_result) {
-    tsqlp_sql_section_destroy(&parse_result->modifiers);
-    tsqlp_sql_section_destroy(&parse_result->columns);
-    tsqlp_sql_section_destroy(&parse_result->first_into);
-    tsqlp_sql_section_destroy(&parse_result->tables);
-    tsqlp_sql_section_destroy(&parse_result->where);
-    tsqlp_sql_section_destroy(&parse_result->group_by);
-    tsqlp_sql_section_destroy(&parse_result->having);
-    tsqlp_sql_section_destroy(&parse_result->order_by);
-    tsqlp_sql_section_destroy(&parse_result->limit);
-    tsqlp_sql_section_destroy(&parse_result->procedure);
-    tsqlp_sql_section_destroy(&parse_result->second_into);
-    tsqlp_sql_section_destroy(&parse_result->flags);
-
-    free(parse_result);
+    struct parse_result_storage *storage = (struct parse_result_storage *) parse_result;
+
+    tsqlp_arena_destroy(&storage->arena);
+
+    free(storage);
 }
 
 const char *tsqlp_parse_status_to_message(tsqlp_parse_status parse_status) {
@@ -1407,6 +2712,16 @@ const char *tsqlp_parse_status_to_message(tsqlp_parse_status parse_status) {
             return "PARSE_INVALID_SYNTAX";
         case TSQLP_PARSE_ERROR_INVALID_ARGUMENT:
             return "PARSE_ERROR_INVALID_ARGUMENT";
+        case TSQLP_PARSE_INVALID_UTF8:
+            return "PARSE_INVALID_UTF8";
+        case TSQLP_PARSE_NESTING_TOO_DEEP:
+            return "PARSE_NESTING_TOO_DEEP";
+        case TSQLP_PARSE_SHALLOW:
+            return "PARSE_SHALLOW";
+        case TSQLP_PARSE_ABORTED:
+            return "PARSE_ABORTED";
+        case TSQLP_PARSE_BUFFER_TOO_SMALL:
+            return "PARSE_BUFFER_TOO_SMALL";
         default:
             return "UNKNOWN";
     }
@@ -3,18 +3,69 @@
 
 #include <stdlib.h>
 
+#include "arena.h"
 #include "include/tsqlp.h"
+#include "lexer.h"
 
 struct tsqlp_placeholders tsqlp_placeholders_new();
 
-void tsqlp_placeholders_push(struct tsqlp_placeholders *placeholders, size_t location);
+void tsqlp_placeholders_push(struct tsqlp_placeholders *placeholders, size_t location, struct tsqlp_arena *arena);
 
-void tsqlp_placeholders_destroy(struct tsqlp_placeholders *placeholders);
+/*
+ * Placeholder locations of a whole parse, every section gets a slice of them. Grown by doubling, and slices taken
+ * before a growth keep pointing to the old copy which stays valid in the arena.
+ */
+struct tsqlp_placeholder_pool {
+    size_t *locations;
+    size_t count;
+    size_t capacity;
+};
+
+struct tsqlp_placeholder_pool tsqlp_placeholder_pool_new();
+
+/*
+ * Makes room for count more locations
+ */
+void tsqlp_placeholder_pool_reserve(struct tsqlp_placeholder_pool *pool, size_t count, struct tsqlp_arena *arena);
+
+/*
+ * Locations added since start, as the placeholders of a section
+ */
+struct tsqlp_placeholders tsqlp_placeholder_pool_slice(const struct tsqlp_placeholder_pool *pool, size_t start);
 
 struct tsqlp_sql_section tsqlp_sql_section_new();
 
-void tsqlp_sql_section_destroy(struct tsqlp_sql_section *sql_section);
+struct tsqlp_hints tsqlp_hints_new();
+
+struct tsqlp_subqueries tsqlp_subqueries_new();
+
+struct tsqlp_ast tsqlp_ast_new();
+
+void tsqlp_sql_section_update(const char *chunk, size_t len, struct tsqlp_placeholders placeholders,
+                              struct tsqlp_sql_section *sql_section, struct tsqlp_arena *arena);
+
+/*
+ * Points the section at chunk instead of copying it
+ */
+void tsqlp_sql_section_view(const char *chunk, size_t len, struct tsqlp_placeholders placeholders,
+                            struct tsqlp_sql_section *sql_section);
+
+/*
+ * Arena owning the sections, placeholders and hints of the result, freed with it
+ */
+struct tsqlp_arena *tsqlp_parse_result_arena(struct tsqlp_parse_result *parse_result);
+
+/*
+ * Public class of a token, as reported by the tokenizer
+ */
+tsqlp_token_type tsqlp_token_type_from(sql_token_type type);
 
-void tsqlp_sql_section_update(const char *chunk, size_t len, struct tsqlp_placeholders placeholders, struct tsqlp_sql_section *sql_section);
+/*
+ * Splits the statement into sections at the clause keywords found outside of parentheses, without checking the
+ * grammar. Fails only when the statement does not start with SELECT, a clause keyword ends it, parentheses do not
+ * match or a token is unknown.
+ */
+tsqlp_parse_status tsqlp_shallow_scan(struct lexer *lexer, struct tsqlp_parse_result *parse_result,
+                                      struct tsqlp_arena *arena, int use_views, unsigned int sections);
 
 #endif //SQL_QUERY_PARSER_TSQLP_H
@@ -0,0 +1,67 @@
+#include "utf8.h"
+#include "simd_scan.h"
+
+/*
+ * ASCII runs are skipped a vector at a time, so the mostly ASCII queries cost about as much as a memchr over them.
+ * Multibyte characters are checked one at a time against the well-formed byte sequences of the Unicode standard.
+ */
+
+/*
+ * Returns length of the well-formed multibyte character at the start of buff, or 0 if there is none
+ */
+static size_t utf8_character_length(const unsigned char *buff, size_t len) {
+    unsigned char first = buff[0];
+    unsigned char second_min = 0x80;
+    unsigned char second_max = 0xbf;
+    size_t character_len;
+
+    if (first >= 0xc2 && first <= 0xdf) {
+        character_len = 2;
+    } else if (first >= 0xe0 && first <= 0xef) {
+        character_len = 3;
+        // Overlong forms and UTF-16 surrogates
+        second_min = first == 0xe0 ? 0xa0 : second_min;
+        second_max = first == 0xed ? 0x9f : second_max;
+    } else if (first >= 0xf0 && first <= 0xf4) {
+        character_len = 4;
+        // Overlong forms and code points above U+10FFFF
+        second_min = first == 0xf0 ? 0x90 : second_min;
+        second_max = first == 0xf4 ? 0x8f : second_max;
+    } else {
+        return 0;
+    }
+
+    if (character_len > len || buff[1] < second_min || buff[1] > second_max) {
+        return 0;
+    }
+
+    for (size_t i = 2; i < character_len; i++) {
+        if ((buff[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+    }
+
+    return character_len;
+}
+
+int utf8_is_valid(const char *buff, size_t len) {
+    size_t offset = simd_scan_skip_ascii(buff, 0, len);
+
+    while (offset < len) {
+        if ((unsigned char) buff[offset] < 0x80) {
+            offset = simd_scan_skip_ascii(buff, offset + 1, len);
+
+            continue;
+        }
+
+        size_t character_len = utf8_character_length((const unsigned char *) buff + offset, len - offset);
+
+        if (character_len == 0) {
+            return 0;
+        }
+
+        offset += character_len;
+    }
+
+    return 1;
+}
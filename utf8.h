@@ -0,0 +1,12 @@
+#ifndef SQL_QUERY_PARSER_UTF8_H
+#define SQL_QUERY_PARSER_UTF8_H
+
+#include <stddef.h>
+
+/*
+ * Returns 1 when buff holds well-formed UTF-8 (RFC 3629: no overlong forms, surrogates or code points above
+ * U+10FFFF), 0 otherwise
+ */
+int utf8_is_valid(const char *buff, size_t len);
+
+#endif //SQL_QUERY_PARSER_UTF8_H